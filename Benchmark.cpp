@@ -0,0 +1,351 @@
+#include "MemoryManager/MemoryManager.h"
+#include "MemoryManager/MemoryManagerPool.h"
+#include <string>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <memory_resource>
+#include <unordered_map>
+#include <cstring>
+
+// Allocation benchmark: throughput and latency percentiles of every fit policy and engine against malloc and
+// std::pmr::monotonic_buffer_resource, over synthetic workloads or a recorded trace.
+//
+// Usage: ./Benchmark [trace file]
+//
+// A trace is either a file written by MemoryManager::startTrace(), or text with one operation per line: "a ID SIZE"
+// allocates SIZE bytes as block ID, "f ID" frees block ID.
+
+// One step of a workload. Blocks are named by id so a workload can be replayed against any allocator.
+struct Operation
+{
+    bool allocate;
+    unsigned id;
+    size_t size;
+};
+
+// Allocator under test. Targets that cannot be shared between threads are skipped by the producer/consumer workload.
+class Target
+{
+public:
+    virtual ~Target() {}
+    virtual std::string name() = 0;
+    virtual void* allocate(size_t size) = 0;
+    virtual void free(void* block) = 0;
+    virtual void reset() = 0; // Drops every block, ready for the next workload
+    virtual bool threadSafe() { return false; }
+};
+
+// MemoryManager with a built-in fit policy or an engine, over an arena well beyond the largest live set of the
+// workloads.
+class ManagerTarget : public Target
+{
+    std::string label;
+    MemoryManager memoryManager;
+    bool concurrent;
+
+public:
+    ManagerTarget(std::string label, std::function<int(int, void*)> allocator, bool concurrent = false)
+        : label(label), memoryManager(8, allocator, OffsetWidth::Bits32), concurrent(concurrent) { reset(); }
+    ManagerTarget(std::string label, Engine engine)
+        : label(label), memoryManager(8, engine, OffsetWidth::Bits32), concurrent(false) { reset(); }
+
+    std::string name() { return label; }
+    void* allocate(size_t size) { return memoryManager.allocate(size); }
+    void free(void* block) { memoryManager.free(block); }
+    void reset()
+    {
+        memoryManager.setConcurrent(false);
+        memoryManager.initialize(1 << 21); // 16MB of 8-byte words
+        memoryManager.setConcurrent(concurrent);
+    }
+    bool threadSafe() { return concurrent; }
+};
+
+// MemoryManagerPool with one arena per CPU and the same total size as ManagerTarget.
+class PoolTarget : public Target
+{
+    MemoryManagerPool pool;
+
+public:
+    PoolTarget() : pool(8, bestFit, OffsetWidth::Bits32) { reset(); }
+
+    std::string name() { return "bestFit pool"; }
+    void* allocate(size_t size) { return pool.allocate(size); }
+    void free(void* block) { pool.free(block); }
+    void reset()
+    {
+        unsigned arenas = std::max(1u, std::thread::hardware_concurrency());
+        pool.initialize((1 << 21) / arenas, arenas);
+    }
+    bool threadSafe() { return true; }
+};
+
+class MallocTarget : public Target
+{
+public:
+    std::string name() { return "malloc"; }
+    void* allocate(size_t size) { return std::malloc(size); }
+    void free(void* block) { std::free(block); }
+    void reset() {}
+    bool threadSafe() { return true; }
+};
+
+// Frees are no-ops and everything is released at once on reset, which bounds how fast an allocator can be.
+class MonotonicTarget : public Target
+{
+    std::pmr::monotonic_buffer_resource resource;
+
+public:
+    std::string name() { return "pmr::monotonic"; }
+    void* allocate(size_t size) { return resource.allocate(size, alignof(std::max_align_t)); }
+    void free(void*) {}
+    void reset() { resource.release(); }
+};
+
+// Latencies of one run, in nanoseconds, plus how many allocations failed.
+struct Result
+{
+    std::vector<uint64_t> latencies;
+    double seconds = 0;
+    size_t failures = 0;
+};
+
+// Keeps the live set between minLive and maxLive blocks, freeing a random live block or allocating a fresh one with
+// a size drawn by nextSize, then frees whatever is left.
+template <typename SizeFunction>
+std::vector<Operation> randomWorkload(size_t operations, size_t maxLive, SizeFunction nextSize)
+{
+    std::mt19937 generator(12345);
+    std::vector<Operation> workload;
+    std::vector<unsigned> live;
+    unsigned nextId = 0;
+
+    while (workload.size() < operations) {
+        bool allocate = live.empty() || (live.size() < maxLive && generator() % 2 == 0);
+        if (allocate) {
+            workload.push_back({true, nextId, nextSize(generator)});
+            live.push_back(nextId++);
+        }
+        else {
+            size_t index = generator() % live.size();
+            workload.push_back({false, live[index], 0});
+            live[index] = live.back();
+            live.pop_back();
+        }
+    }
+    for (unsigned id : live) { workload.push_back({false, id, 0}); }
+    return workload;
+}
+
+// Sizes uniform between 8 and 512 bytes.
+std::vector<Operation> uniformWorkload(size_t operations)
+{
+    std::uniform_int_distribution<size_t> size(8, 512);
+    return randomWorkload(operations, 4096, [&](std::mt19937& generator) { return size(generator); });
+}
+
+// Mostly small sizes with a long tail of large ones (Pareto, alpha 1.2), as most real programs allocate.
+std::vector<Operation> powerLawWorkload(size_t operations)
+{
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    return randomWorkload(operations, 4096, [&](std::mt19937& generator) {
+        double size = 16 * std::pow(1.0 - uniform(generator), -1.0 / 1.2);
+        return (size_t)std::min(size, 65536.0);
+    });
+}
+
+// Reads a trace written by MemoryManager::startTrace(). Blocks are named by the word offset they were given, and
+// allocations that failed when the trace was recorded are left out.
+std::vector<Operation> binaryTraceWorkload(std::ifstream& traceFile)
+{
+    std::vector<Operation> workload;
+    TraceHeader header;
+    if (!traceFile.read((char*)&header, sizeof(header)) || header.recordSize != sizeof(TraceRecord)) { return workload; }
+
+    std::unordered_map<uint32_t, unsigned> liveIds; // Word offset to block id
+    unsigned nextId = 0;
+    TraceRecord record;
+    while (traceFile.read((char*)&record, sizeof(record))) {
+        if (record.offset == TraceRecord::noOffset) { continue; }
+        if (record.event == TraceEvent::Allocate) {
+            liveIds[record.offset] = nextId;
+            workload.push_back({true, nextId++, record.size});
+        }
+        else if (record.event == TraceEvent::Free) {
+            auto live = liveIds.find(record.offset);
+            if (live == liveIds.end()) { continue; } // Allocated before the trace started
+            workload.push_back({false, live->second, 0});
+            liveIds.erase(live);
+        }
+    }
+    return workload;
+}
+
+// Reads a trace recorded from a real workload, see the formats at the top of this file.
+std::vector<Operation> traceWorkload(std::string fileName)
+{
+    std::vector<Operation> workload;
+    std::ifstream traceFile(fileName, std::ios::binary);
+    char magic[8] = {};
+    traceFile.read(magic, sizeof(magic));
+    traceFile.clear();
+    traceFile.seekg(0);
+    if (std::memcmp(magic, "MMTRACE1", sizeof(magic)) == 0) { return binaryTraceWorkload(traceFile); }
+
+    std::string line;
+    while (std::getline(traceFile, line)) {
+        std::istringstream fields(line);
+        char kind;
+        Operation operation = {false, 0, 0};
+        if (!(fields >> kind >> operation.id)) { continue; }
+        operation.allocate = kind == 'a';
+        if (operation.allocate) { fields >> operation.size; }
+        workload.push_back(operation);
+    }
+    return workload;
+}
+
+// Runs a workload once, timing every operation.
+Result replay(Target& target, const std::vector<Operation>& workload)
+{
+    Result result;
+    result.latencies.reserve(workload.size());
+    std::vector<void*> blocks;
+
+    auto start = std::chrono::steady_clock::now();
+    for (const Operation& operation : workload) {
+        if (operation.id >= blocks.size()) { blocks.resize(operation.id + 1, nullptr); }
+        auto before = std::chrono::steady_clock::now();
+        if (operation.allocate) {
+            blocks[operation.id] = target.allocate(operation.size);
+            if (blocks[operation.id] == nullptr) { ++result.failures; }
+        }
+        else if (blocks[operation.id] != nullptr) {
+            target.free(blocks[operation.id]);
+            blocks[operation.id] = nullptr;
+        }
+        auto after = std::chrono::steady_clock::now();
+        result.latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(after - before).count());
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    target.reset();
+    return result;
+}
+
+// One thread allocates blocks and hands them to another that frees them, through a bounded single-producer,
+// single-consumer ring, so every block is freed by a different thread than the one that allocated it.
+Result producerConsumer(Target& target, size_t blocks)
+{
+    const size_t capacity = 1024;
+    std::vector<void*> ring(capacity);
+    std::atomic<size_t> head(0), tail(0);
+    Result producer, consumer;
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread consumerThread([&]() {
+        for (size_t freed = 0; freed < blocks; ++freed) {
+            size_t position = tail.load(std::memory_order_relaxed);
+            while (head.load(std::memory_order_acquire) == position) { std::this_thread::yield(); }
+            void* block = ring[position % capacity];
+            tail.store(position + 1, std::memory_order_release);
+
+            auto before = std::chrono::steady_clock::now();
+            if (block != nullptr) { target.free(block); }
+            consumer.latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - before).count());
+        }
+    });
+
+    std::mt19937 generator(12345);
+    for (size_t allocated = 0; allocated < blocks; ++allocated) {
+        auto before = std::chrono::steady_clock::now();
+        void* block = target.allocate(16 + generator() % 240);
+        producer.latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - before).count());
+        if (block == nullptr) { ++producer.failures; }
+
+        size_t position = head.load(std::memory_order_relaxed);
+        while (position - tail.load(std::memory_order_acquire) == capacity) { std::this_thread::yield(); }
+        ring[position % capacity] = block;
+        head.store(position + 1, std::memory_order_release);
+    }
+    consumerThread.join();
+
+    producer.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    producer.latencies.insert(producer.latencies.end(), consumer.latencies.begin(), consumer.latencies.end());
+    target.reset();
+    return producer;
+}
+
+// Returns the latency below which fraction of the operations completed.
+uint64_t percentile(std::vector<uint64_t>& latencies, double fraction)
+{
+    if (latencies.empty()) { return 0; }
+    size_t index = std::min(latencies.size() - 1, (size_t)(fraction * latencies.size()));
+    std::nth_element(latencies.begin(), latencies.begin() + index, latencies.end());
+    return latencies[index];
+}
+
+void printHeader(std::string workload)
+{
+    std::cout << "\n" << workload << std::endl;
+    std::cout << std::left << std::setw(18) << "target" << std::right << std::setw(12) << "Mops/s"
+              << std::setw(10) << "p50 ns" << std::setw(10) << "p99 ns" << std::setw(10) << "p999 ns"
+              << std::setw(10) << "failures" << std::endl;
+}
+
+void printResult(std::string target, Result& result)
+{
+    double throughput = result.latencies.size() / result.seconds / 1e6;
+    std::cout << std::left << std::setw(18) << target << std::right << std::setw(12) << std::fixed
+              << std::setprecision(2) << throughput << std::setw(10) << percentile(result.latencies, 0.50)
+              << std::setw(10) << percentile(result.latencies, 0.99) << std::setw(10)
+              << percentile(result.latencies, 0.999) << std::setw(10) << result.failures << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::unique_ptr<Target>> targets;
+    targets.emplace_back(new ManagerTarget("bestFit", bestFit));
+    targets.emplace_back(new ManagerTarget("worstFit", worstFit));
+    targets.emplace_back(new ManagerTarget("firstFit", firstFit));
+    targets.emplace_back(new ManagerTarget("nextFit", nextFit));
+    targets.emplace_back(new ManagerTarget("buddy", Engine::Buddy));
+    targets.emplace_back(new ManagerTarget("tlsf", Engine::TLSF));
+    targets.emplace_back(new ManagerTarget("bestFit concurrent", bestFit, true));
+    targets.emplace_back(new PoolTarget());
+    targets.emplace_back(new MallocTarget());
+    targets.emplace_back(new MonotonicTarget());
+
+    std::vector<std::pair<std::string, std::vector<Operation>>> workloads;
+    if (argc > 1) { workloads.push_back({std::string("trace ") + argv[1], traceWorkload(argv[1])}); }
+    else {
+        workloads.push_back({"uniform 8-512 bytes", uniformWorkload(200000)});
+        workloads.push_back({"power-law 16-65536 bytes", powerLawWorkload(200000)});
+    }
+
+    for (auto& workload : workloads) {
+        printHeader(workload.first + " (" + std::to_string(workload.second.size()) + " operations)");
+        for (auto& target : targets) {
+            Result result = replay(*target, workload.second);
+            printResult(target->name(), result);
+        }
+    }
+
+    if (argc <= 1) {
+        printHeader("producer/consumer 16-256 bytes (200000 blocks)");
+        for (auto& target : targets) {
+            if (!target->threadSafe()) { continue; }
+            Result result = producerConsumer(*target, 200000);
+            printResult(target->name(), result);
+        }
+    }
+}
@@ -1,4 +1,11 @@
 #include "MemoryManager/MemoryManager.h"
+#include "MemoryManager/PoolAllocator.h"
+#include "MemoryManager/BumpArena.h"
+#include "MemoryManager/BasicMemoryManager.h"
+#include "MemoryManager/GrowableMemoryManager.h"
+#include "MemoryManager/MemoryManagerResource.h"
+#include "MemoryManager/StaticMemoryManager.h"
+#include "MemoryManager/MemoryManagerPool.h"
 #include <string>
 #include <cmath>
 #include <array>
@@ -6,6 +13,10 @@
 #include <fstream>
 #include <vector>
 #include <iostream>
+#include <thread>
+#include <atomic>
+#include <unordered_map>
+#include <sched.h>
 
 
 
@@ -20,12 +31,37 @@ unsigned int testRepeatedShutdown();
 unsigned int testMaxInitialization();
 unsigned int testGetters();
 unsigned int testReadingUsingGetMemoryStart();
+unsigned int testCoalescingFree();
+unsigned int testFirstAndNextFit();
+unsigned int testWideOffsets();
+unsigned int testConcurrentAllocate();
+unsigned int testPoolAllocator();
+unsigned int testBumpArena();
+unsigned int testBuddyEngine();
+unsigned int testAllocateAligned();
+unsigned int testReallocate();
+unsigned int testBatchAllocate();
+unsigned int testPolicyTemplate();
+unsigned int testGrowableArena();
+unsigned int testMappedArena();
+unsigned int testPersistentArena();
+unsigned int testBinaryDump();
+unsigned int testStats();
+unsigned int testTraceRecording();
+unsigned int testMemoryResource();
+unsigned int testSizedFree();
+unsigned int testCompaction();
+unsigned int testDeferredFree();
+unsigned int testTLSFEngine();
+unsigned int testStaticMemoryManager();
+unsigned int testCallerBuffers();
+unsigned int testMemoryManagerPool();
 
 
 // helper functions
 std::string vectorToString(const std::vector<uint16_t>& vector);
-unsigned int testGetBitmap(MemoryManager& memoryManager, uint16_t correctBitmapLength, std::vector<uint8_t> correctBitmap);
-unsigned int testGetList(MemoryManager& memoryManager, uint16_t correctListLength, std::vector<uint16_t> correctList);
+unsigned int testGetBitmap(MemoryManager& memoryManager, std::vector<uint8_t> correctBitmap);
+unsigned int testGetList(MemoryManager& memoryManager, std::vector<uint16_t> correctList);
 unsigned int testGetWordSize(MemoryManager& memoryManager, size_t correctWordSize);
 unsigned int testGetMemoryLimit(MemoryManager& memoryManager, size_t correctMemoryLimit);
 unsigned int testDumpMemoryMap(MemoryManager& memoryManager, std::string fileName, std::string correctFileContents);
@@ -78,7 +114,7 @@ int hopesAndDreamsAllocator(int sizeInWords, void* list)
 
 int main()
 {
-    unsigned int maxScore = 38;
+    unsigned int maxScore = 118;
     unsigned int score = 0;
     
     score += testMemoryLeaksNoShutdown(); // 0
@@ -108,6 +144,81 @@ int main()
     std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
     
     score += 5 * testReadingUsingGetMemoryStart(); // 1 * 5
+    std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
+
+    score += testCoalescingFree(); // 2
+    std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
+
+    score += testFirstAndNextFit(); // 4
+    std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
+
+    score += testWideOffsets(); // 2
+    std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
+
+    score += testConcurrentAllocate(); // 3
+    std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
+
+    score += testPoolAllocator(); // 2
+    std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
+
+    score += testBumpArena(); // 2
+    std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
+
+    score += testBuddyEngine(); // 6
+    std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
+
+    score += testAllocateAligned(); // 3
+    std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
+
+    score += testReallocate(); // 4
+    std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
+
+    score += testBatchAllocate(); // 4
+    std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
+
+    score += testPolicyTemplate(); // 4
+    std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
+
+    score += testGrowableArena(); // 3
+    std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
+
+    score += testMappedArena(); // 3
+    std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
+
+    score += testPersistentArena(); // 5
+    std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
+
+    score += testBinaryDump(); // 3
+    std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
+
+    score += testStats(); // 4
+    std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
+
+    score += testTraceRecording(); // 2
+    std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
+
+    score += testMemoryResource(); // 3
+    std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
+
+    score += testSizedFree(); // 2
+    std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
+
+    score += testCompaction(); // 3
+    std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
+
+    score += testDeferredFree(); // 4
+    std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
+
+    score += testTLSFEngine(); // 4
+    std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
+
+    score += testStaticMemoryManager(); // 3
+    std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
+
+    score += testCallerBuffers(); // 2
+    std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
+
+    score += testMemoryManagerPool(); // 3
     
     std::cout << "Score: " << score << " / " <<  maxScore << std::endl;
 }
@@ -150,25 +261,23 @@ unsigned int testSimpleFirstFit()
     std::cout << "allocating and freeing memory..." << std::endl;
 
     uint64_t* testArray1 = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 10));
-    uint64_t* testArray2 = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 2));
+    memoryManager.allocate(sizeof(uint64_t) * 2);
     uint64_t* testArray3 = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 2));
-    uint64_t* testArray4 = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 6));
+    memoryManager.allocate(sizeof(uint64_t) * 6);
 
     memoryManager.free(testArray1);
     memoryManager.free(testArray3);
 
     std::vector<uint8_t> correctBitmap{0x00,0xCC,0x0F,0x00};
-    uint16_t correctBitmapLength = correctBitmap.size();
 
     std::vector<uint16_t> correctList = {0, 10, 12, 2, 20, 6};
-    uint16_t correctListLength = correctList.size() * 2;
 
     std::cout << "Testing Memory Manager state after allocations and frees" << std::endl;
 
 
     unsigned int score = 0;
-    score += testGetBitmap(memoryManager, correctBitmapLength, correctBitmap);
-    score += testGetList(memoryManager, correctListLength, correctList);
+    score += testGetBitmap(memoryManager, correctBitmap);
+    score += testGetList(memoryManager, correctList);
     score += testDumpMemoryMap(memoryManager, "testSimpleFirstFit.txt", vectorToString(correctList));
 
     memoryManager.shutdown();
@@ -182,15 +291,15 @@ unsigned int testSimpleBestFit()
     std::cout << "Test Case: Best Fit 1" << std::endl;
     unsigned int wordSize = 8;
     size_t numberOfWords = 96;
-    MemoryManager memoryManager(8, worstFit);
+    MemoryManager memoryManager(wordSize, worstFit);
     memoryManager.initialize(numberOfWords);
     // allocate
-    uint32_t* testArray1 = static_cast<uint32_t*>(memoryManager.allocate(sizeof(uint32_t) * 4));
-    uint32_t* testArray2 = static_cast<uint32_t*>(memoryManager.allocate(sizeof(uint32_t) * 4));
+    memoryManager.allocate(sizeof(uint32_t) * 4);
+    memoryManager.allocate(sizeof(uint32_t) * 4);
     uint32_t* testArray3 = static_cast<uint32_t*>(memoryManager.allocate(sizeof(uint32_t) * 10));
-    uint32_t* testArray4 = static_cast<uint32_t*>(memoryManager.allocate(sizeof(uint32_t) * 4));
+    memoryManager.allocate(sizeof(uint32_t) * 4);
     uint32_t* testArray5 = static_cast<uint32_t*>(memoryManager.allocate(sizeof(uint32_t) * 4));
-    uint32_t* testArray6 = static_cast<uint32_t*>(memoryManager.allocate(sizeof(uint32_t) * 10));
+    memoryManager.allocate(sizeof(uint32_t) * 10);
     
 
     // free specific allocations to create holes
@@ -201,13 +310,12 @@ unsigned int testSimpleBestFit()
 
     std::cout << "allocating 4 words" << std::endl;
 
-    uint32_t* testArray7 = static_cast<uint32_t*>(memoryManager.allocate(sizeof(uint32_t) * 4));
+    memoryManager.allocate(sizeof(uint32_t) * 4);
 
 
     std::vector<uint8_t> correctBitmap{0x0F, 0xFE, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
 
     std::vector<uint16_t> correctList = {4,5,18,78};
-    uint16_t correctListLength = correctList.size() * 2;
 
     std::string correctFileContents = vectorToString(correctList);
 
@@ -215,8 +323,8 @@ unsigned int testSimpleBestFit()
 
     std::cout << "Testing Memory Manager state after allocation" << std::endl;
 
-    score += testGetBitmap(memoryManager, correctBitmap.size(), correctBitmap);
-    score += testGetList(memoryManager, correctListLength, correctList);
+    score += testGetBitmap(memoryManager, correctBitmap);
+    score += testGetList(memoryManager, correctList);
     score += testDumpMemoryMap(memoryManager, "testSimpleBestFit.txt", vectorToString(correctList));
 
     memoryManager.shutdown();
@@ -233,15 +341,15 @@ unsigned int testComplexBestFit()
     MemoryManager memoryManager(wordSize, worstFit);
     memoryManager.initialize(numberOfWords);
 
-    uint32_t* testArray1 = static_cast<uint32_t*>(memoryManager.allocate(sizeof(uint32_t) * 10));
+    memoryManager.allocate(sizeof(uint32_t) * 10);
     uint32_t* testArray2 = static_cast<uint32_t*>(memoryManager.allocate(sizeof(uint32_t) * 4));
-    uint32_t* testArray3 = static_cast<uint32_t*>(memoryManager.allocate(sizeof(uint32_t) * 10));
+    memoryManager.allocate(sizeof(uint32_t) * 10);
     uint32_t* testArray4 = static_cast<uint32_t*>(memoryManager.allocate(sizeof(uint32_t) * 3));
-    uint32_t* testArray5 = static_cast<uint32_t*>(memoryManager.allocate(sizeof(uint32_t) * 10));
+    memoryManager.allocate(sizeof(uint32_t) * 10);
     uint32_t* testArray6 = static_cast<uint32_t*>(memoryManager.allocate(sizeof(uint32_t) * 2));
-    uint32_t* testArray7 = static_cast<uint32_t*>(memoryManager.allocate(sizeof(uint32_t) * 10));
+    memoryManager.allocate(sizeof(uint32_t) * 10);
     uint32_t* testArray8 = static_cast<uint32_t*>(memoryManager.allocate(sizeof(uint32_t) * 1));
-    uint32_t* testArray9 = static_cast<uint32_t*>(memoryManager.allocate(sizeof(uint32_t) * 10));
+    memoryManager.allocate(sizeof(uint32_t) * 10);
 
 
     unsigned int score = 0;
@@ -249,12 +357,11 @@ unsigned int testComplexBestFit()
     std::vector<uint8_t> correctBitmapBeforeFree{0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x0F, 0x00, 0x00, 0x00, 0x00};
 
     std::vector<uint16_t> correctListBeforeFree = {60, 36};
-    uint16_t correctListLengthBeforeFree = correctListBeforeFree.size() * 2;
 
     std::cout << "Testing Memory Manager state after initial allocations" << std::endl;
 
-    score += testGetBitmap(memoryManager, correctBitmapBeforeFree.size(), correctBitmapBeforeFree);
-    score += testGetList(memoryManager, correctListLengthBeforeFree, correctListBeforeFree);
+    score += testGetBitmap(memoryManager, correctBitmapBeforeFree);
+    score += testGetList(memoryManager, correctListBeforeFree);
 
     
 
@@ -267,13 +374,12 @@ unsigned int testComplexBestFit()
     std::vector<uint8_t> correctBitmapAfterFree{0xFF, 0xC3, 0xFF, 0xF8, 0x9F, 0xFF, 0xFD, 0x0F, 0x00, 0x00, 0x00, 0x00};
 
     std::vector<uint16_t> correctListAfterFree = {10, 4, 24, 3, 37, 2, 49, 1, 60, 36};
-    uint16_t correctListLengthAfterFree = correctListAfterFree.size() * 2;
 
     std::cout << "Testing Memory Manager state after freeing specific areas " << std::endl;
 
 
-    score += testGetBitmap(memoryManager, correctBitmapAfterFree.size(), correctBitmapAfterFree);
-    score += testGetList(memoryManager, correctListLengthAfterFree, correctListAfterFree);
+    score += testGetBitmap(memoryManager, correctBitmapAfterFree);
+    score += testGetList(memoryManager, correctListAfterFree);
 
 
     // change allocator
@@ -282,52 +388,49 @@ unsigned int testComplexBestFit()
     std::cout << "Allocating 1 words" <<std::endl;
 
 
-    uint32_t* testArray10 = static_cast<uint32_t*>(memoryManager.allocate(sizeof(uint32_t) * 1));
+    memoryManager.allocate(sizeof(uint32_t) * 1);
 
     std::vector<uint8_t> correctBitmapAfter1{0xFF, 0xC3, 0xFF, 0xF8, 0x9F, 0xFF, 0xFF, 0x0F, 0x00, 0x00, 0x00, 0x00};
 
     std::vector<uint16_t> correctListAfter1 = {10, 4, 24, 3, 37, 2, 60, 36};
-    uint16_t correctListLengthAfter1 = correctListAfter1.size() * 2;
 
     std::cout << "Testing Memory Manager state\n" << std::endl;
 
 
-    score += testGetBitmap(memoryManager, correctBitmapAfter1.size(), correctBitmapAfter1);
-    score += testGetList(memoryManager, correctListLengthAfter1, correctListAfter1);
+    score += testGetBitmap(memoryManager, correctBitmapAfter1);
+    score += testGetList(memoryManager, correctListAfter1);
 
     std::cout << "Allocating 2 words" <<std::endl;
 
 
-    uint32_t* testArray11 = static_cast<uint32_t*>(memoryManager.allocate(sizeof(uint32_t) * 2));
+    memoryManager.allocate(sizeof(uint32_t) * 2);
 
     std::vector<uint8_t> correctBitmapAfter2{0xFF, 0xC3, 0xFF, 0xF8, 0xFF, 0xFF, 0xFF, 0x0F, 0x00, 0x00, 0x00, 0x00};
 
     std::vector<uint16_t> correctListAfter2 = {10, 4, 24, 3, 60, 36};
-    uint16_t correctListLengthAfter2 = correctListAfter2.size() * 2;
 
     std::cout << "Testing Memory Manager state\n" << std::endl;
 
 
-    score += testGetBitmap(memoryManager, correctBitmapAfter2.size(), correctBitmapAfter2);
-    score += testGetList(memoryManager, correctListLengthAfter2, correctListAfter2);
+    score += testGetBitmap(memoryManager, correctBitmapAfter2);
+    score += testGetList(memoryManager, correctListAfter2);
 
     std::cout << "Allocating 3 words" <<std::endl;
 
 
-    uint32_t* testArray12 = static_cast<uint32_t*>(memoryManager.allocate(sizeof(uint32_t) * 3));
+    memoryManager.allocate(sizeof(uint32_t) * 3);
 
     std::vector<uint8_t> correctBitmapAfter3{0xFF, 0xC3, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x0F, 0x00, 0x00, 0x00, 0x00};
 
     std::vector<uint16_t> correctListAfter3 = {10, 4, 60, 36};
-    uint16_t correctListLengthAfter3 = correctListAfter3.size() * 2;
 
     std::cout << "Testing Memory Manager state\n" << std::endl;
 
 
-    score += testGetBitmap(memoryManager, correctBitmapAfter3.size(), correctBitmapAfter3);
-    score += testGetList(memoryManager, correctListLengthAfter3, correctListAfter3);
+    score += testGetBitmap(memoryManager, correctBitmapAfter3);
+    score += testGetList(memoryManager, correctListAfter3);
 
-    uint32_t* testArray13 = static_cast<uint32_t*>(memoryManager.allocate(sizeof(uint32_t) * 4));
+    memoryManager.allocate(sizeof(uint32_t) * 4);
 
     std::cout << "Allocating 4 words" <<std::endl;
 
@@ -335,13 +438,12 @@ unsigned int testComplexBestFit()
     std::vector<uint8_t> correctBitmapAfter4{0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x0F, 0x00, 0x00, 0x00, 0x00};
 
     std::vector<uint16_t> correctListAfter4 = {60, 36};
-    uint16_t correctListLengthAfter4 = correctListAfter4.size() * 2;
 
     std::cout << "Testing Memory Manager state\n" << std::endl;
 
 
-    score += testGetBitmap(memoryManager, correctBitmapAfter4.size(), correctBitmapAfter4);
-    score += testGetList(memoryManager, correctListLengthAfter4, correctListAfter4);
+    score += testGetBitmap(memoryManager, correctBitmapAfter4);
+    score += testGetList(memoryManager, correctListAfter4);
     score += testDumpMemoryMap(memoryManager, "testComplexBestFit.txt", vectorToString(correctListAfter4));
 
     memoryManager.shutdown();
@@ -359,13 +461,13 @@ unsigned int testNewAllocator()
     memoryManager.initialize(numberOfWords);
 
 
-    uint64_t* testArray1 = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 10));
+    memoryManager.allocate(sizeof(uint64_t) * 10);
     uint64_t* testArray2 = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 13));
-    uint64_t* testArray3 = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 10));
+    memoryManager.allocate(sizeof(uint64_t) * 10);
     uint64_t* testArray4 = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 8));
-    uint64_t* testArray5 = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 10));
+    memoryManager.allocate(sizeof(uint64_t) * 10);
     uint64_t* testArray6 = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 4));
-    uint64_t* testArray7 = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 10));
+    memoryManager.allocate(sizeof(uint64_t) * 10);
 
     memoryManager.free(testArray2);
     memoryManager.free(testArray4);
@@ -377,48 +479,45 @@ unsigned int testNewAllocator()
 
     std::cout << "Allocating 4 words" <<std::endl;
 
-    uint64_t* testArray8 = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 4));
+    memoryManager.allocate(sizeof(uint64_t) * 4);
 
     std::vector<uint8_t> correctBitmapAfter1{0xFF, 0x03, 0x80, 0xFF, 0x01, 0xFE, 0x87, 0xFF, 0x1F, 0x00, 0x00};
 
     std::vector<uint16_t> correctListAfter1 = {10, 13, 33, 8, 51, 4, 69, 19};
-    uint16_t correctListLengthAfter1 = correctListAfter1.size() * 2;
 
     std::cout << "Testing Memory Manager state\n" << std::endl;
 
-    score += testGetBitmap(memoryManager, correctBitmapAfter1.size(), correctBitmapAfter1);
-    score += testGetList(memoryManager, correctListLengthAfter1, correctListAfter1);
+    score += testGetBitmap(memoryManager, correctBitmapAfter1);
+    score += testGetList(memoryManager, correctListAfter1);
 
     std::cout << "Allocating 4 words" <<std::endl;
 
 
-    uint64_t* testArray9 = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 4));
+    memoryManager.allocate(sizeof(uint64_t) * 4);
         
     std::vector<uint8_t> correctBitmapAfter2{0xFF, 0x3F, 0x80, 0xFF, 0x01, 0xFE, 0x87, 0xFF, 0x1F, 0x00, 0x00};
 
     std::vector<uint16_t> correctListAfter2 = {14, 9, 33, 8, 51, 4, 69, 19};
-    uint16_t correctListLengthAfter2 = correctListAfter2.size() * 2;
 
     std::cout << "Testing Memory Manager state\n" << std::endl;
 
 
-    score += testGetBitmap(memoryManager, correctBitmapAfter2.size(), correctBitmapAfter2);
-    score += testGetList(memoryManager, correctListLengthAfter2, correctListAfter2);
+    score += testGetBitmap(memoryManager, correctBitmapAfter2);
+    score += testGetList(memoryManager, correctListAfter2);
 
     std::cout << "Allocating 4 words" <<std::endl;
 
 
-    uint64_t* testArray10 = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 4));
+    memoryManager.allocate(sizeof(uint64_t) * 4);
 
     std::vector<uint8_t> correctBitmapAfter3{0xFF, 0x3F, 0x80, 0xFF, 0x1F, 0xFE, 0x87, 0xFF, 0x1F, 0x00, 0x00};
 
     std::vector<uint16_t> correctListAfter3 = {14, 9, 37, 4, 51, 4, 69, 19};
-    uint16_t correctListLengthAfter3 = correctListAfter3.size() * 2;
 
     std::cout << "Testing Memory Manager state\n" << std::endl;
 
-    score += testGetBitmap(memoryManager, correctBitmapAfter3.size(), correctBitmapAfter3);
-    score += testGetList(memoryManager, correctListLengthAfter3, correctListAfter3);
+    score += testGetBitmap(memoryManager, correctBitmapAfter3);
+    score += testGetList(memoryManager, correctListAfter3);
     score += testDumpMemoryMap(memoryManager, "testNewAllocator.txt", vectorToString(correctListAfter3));
 
 
@@ -436,7 +535,7 @@ unsigned int testInvalidAllocate()
     MemoryManager memoryManager(wordSize, worstFit);
     memoryManager.initialize(numberOfWords);
 
-    uint16_t* testArray1 = static_cast<uint16_t*>(memoryManager.allocate(sizeof(uint16_t) * numberOfWords));
+    memoryManager.allocate(sizeof(uint16_t) * numberOfWords);
     uint16_t* testArray2 = static_cast<uint16_t*>(memoryManager.allocate(sizeof(uint16_t) * 1));
 
     if(testArray2 == nullptr) {
@@ -459,10 +558,10 @@ unsigned int testRepeatedShutdown()
     memoryManager.initialize(numberOfWords1);
 
     uint16_t* testArray1 = static_cast<uint16_t*>(memoryManager.allocate(sizeof(uint16_t) * 1));
-    uint16_t* testArray2 = static_cast<uint16_t*>(memoryManager.allocate(sizeof(uint16_t) * 2));
-    uint16_t* testArray3 = static_cast<uint16_t*>(memoryManager.allocate(sizeof(uint16_t) * 1));
-    uint16_t* testArray4 = static_cast<uint16_t*>(memoryManager.allocate(sizeof(uint16_t) * 2));
-    uint16_t* testArray5 = static_cast<uint16_t*>(memoryManager.allocate(sizeof(uint16_t) * 1));
+    memoryManager.allocate(sizeof(uint16_t) * 2);
+    memoryManager.allocate(sizeof(uint16_t) * 1);
+    memoryManager.allocate(sizeof(uint16_t) * 2);
+    memoryManager.allocate(sizeof(uint16_t) * 1);
 
     memoryManager.free(testArray1);
 
@@ -475,11 +574,11 @@ unsigned int testRepeatedShutdown()
 
     memoryManager.initialize(numberOfWords2);
 
-    uint16_t* testArray6 = static_cast<uint16_t*>(memoryManager.allocate(sizeof(uint16_t) * 1));
+    memoryManager.allocate(sizeof(uint16_t) * 1);
     uint16_t* testArray7 = static_cast<uint16_t*>(memoryManager.allocate(sizeof(uint16_t) * 2));
     uint16_t* testArray8 = static_cast<uint16_t*>(memoryManager.allocate(sizeof(uint16_t) * 1));
-    uint16_t* testArray9 = static_cast<uint16_t*>(memoryManager.allocate(sizeof(uint16_t) * 2));
-    uint16_t* testArray10 = static_cast<uint16_t*>(memoryManager.allocate(sizeof(uint16_t) * 1));
+    memoryManager.allocate(sizeof(uint16_t) * 2);
+    memoryManager.allocate(sizeof(uint16_t) * 1);
 
     memoryManager.free(testArray7);
     memoryManager.free(testArray8);
@@ -488,13 +587,12 @@ unsigned int testRepeatedShutdown()
     std::vector<uint8_t> correctBitmap{0x71, 0x00, 0x00};
 
     std::vector<uint16_t> correctList = {1,3,7,13};
-    uint16_t correctListLength = correctList.size() * 2;
 
     unsigned int score = 0;
 
     std::cout << "Testing Memory Manager state\n" << std::endl;
-    score += testGetBitmap(memoryManager, correctBitmap.size(), correctBitmap);
-    score += testGetList(memoryManager, correctListLength, correctList);
+    score += testGetBitmap(memoryManager, correctBitmap);
+    score += testGetList(memoryManager, correctList);
     score += testDumpMemoryMap(memoryManager, "testRepeatedShutdown.txt", vectorToString(correctList));
 
 
@@ -537,9 +635,9 @@ unsigned int testGetters()
     memoryManager.initialize(numberOfWords);
 
     uint64_t* testArray1 = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 10));
-    uint64_t* testArray2 = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 2));
+    memoryManager.allocate(sizeof(uint64_t) * 2);
     uint64_t* testArray3 = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 2));
-    uint64_t* testArray4 = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 6));
+    memoryManager.allocate(sizeof(uint64_t) * 6);
 
     memoryManager.free(testArray1);
     memoryManager.free(testArray3);
@@ -604,12 +702,1541 @@ unsigned int testReadingUsingGetMemoryStart()
 }
 
 
+unsigned int testCoalescingFree()
+{
+    std::cout << "Test Case: freeing between two holes" << std::endl;
+    unsigned int wordSize = 8;
+    size_t numberOfWords = 16;
+    MemoryManager memoryManager(wordSize, bestFit);
+    memoryManager.initialize(numberOfWords);
+
+    uint64_t* testArray1 = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 2));
+    uint64_t* testArray2 = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 3));
+    uint64_t* testArray3 = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 4));
+    memoryManager.allocate(sizeof(uint64_t) * 1);
+
+    memoryManager.free(testArray1);
+    memoryManager.free(testArray3);
+    memoryManager.free(testArray2);
+
+    std::vector<uint8_t> correctBitmap{0x00, 0x02};
+
+    std::vector<uint16_t> correctList = {0, 9, 10, 6};
+
+    unsigned int score = 0;
+
+    std::cout << "Testing Memory Manager state\n" << std::endl;
+    score += testGetBitmap(memoryManager, correctBitmap);
+    score += testGetList(memoryManager, correctList);
+
+    memoryManager.shutdown();
+
+    return score;
+}
+
+
+unsigned int testFirstAndNextFit()
+{
+    std::cout << "Test Case: First Fit and Next Fit" << std::endl;
+    unsigned int wordSize = 8;
+    size_t numberOfWords = 26;
+    unsigned int score = 0;
+
+    // Same layout as testSimpleFirstFit: holes [0, 10] - [12, 2] - [20, 6]
+    for (auto allocator : {firstFit, nextFit}) {
+        MemoryManager memoryManager(wordSize, allocator);
+        memoryManager.initialize(numberOfWords);
+
+        uint64_t* testArray1 = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 10));
+        memoryManager.allocate(sizeof(uint64_t) * 2);
+        uint64_t* testArray3 = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 2));
+        memoryManager.allocate(sizeof(uint64_t) * 6);
+
+        memoryManager.free(testArray1);
+        memoryManager.free(testArray3);
+
+        std::cout << "Allocating 2 words" << std::endl;
+        memoryManager.allocate(sizeof(uint64_t) * 2);
+
+        std::vector<uint8_t> correctBitmap;
+        std::vector<uint16_t> correctList;
+        if (allocator == firstFit) { // Lowest hole that fits
+            correctBitmap = {0x03, 0xCC, 0x0F, 0x00};
+            correctList = {2, 8, 12, 2, 20, 6};
+        }
+        else { // Carries on from the end of the last allocation
+            correctBitmap = {0x00, 0xCC, 0x3F, 0x00};
+            correctList = {0, 10, 12, 2, 22, 4};
+        }
+
+        std::cout << "Testing Memory Manager state\n" << std::endl;
+        score += testGetBitmap(memoryManager, correctBitmap);
+        score += testGetList(memoryManager, correctList);
+
+        memoryManager.shutdown();
+    }
+
+    return score;
+}
+
+
+unsigned int testWideOffsets()
+{
+    std::cout << "Test Case: 32-bit offsets, arena larger than 65535 words" << std::endl;
+    unsigned int wordSize = 4;
+    size_t numberOfWords = 100000;
+    MemoryManager memoryManager(wordSize, bestFit, OffsetWidth::Bits32);
+    memoryManager.initialize(numberOfWords);
+
+    uint32_t* testArray1 = static_cast<uint32_t*>(memoryManager.allocate(sizeof(uint32_t) * 70000));
+    memoryManager.allocate(sizeof(uint32_t) * 20000);
+    memoryManager.free(testArray1);
+
+    unsigned int score = 0;
+
+    std::cout << "Testing getList" << std::endl;
+    std::vector<uint32_t> correctList = {2, 0, 70000, 90000, 10000};
+    uint32_t* list = static_cast<uint32_t*>(memoryManager.getList());
+    if (list && std::equal(correctList.begin(), correctList.end(), list)) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    delete [] list;
+
+    std::cout << "Testing getBitmap" << std::endl;
+    uint8_t* bitmap = static_cast<uint8_t*>(memoryManager.getBitmap());
+    uint32_t byteStreamLength = bitmap[0] | (bitmap[1] << 8) | (bitmap[2] << 16) | (bitmap[3] << 24);
+    if (byteStreamLength == 12500 && bitmap[4] == 0x00 && bitmap[4 + 8750] == 0xFF && bitmap[4 + 11250] == 0x00) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    delete [] bitmap;
+
+    memoryManager.shutdown();
+
+    return score;
+}
+
+
+unsigned int testConcurrentAllocate()
+{
+    std::cout << "Test Case: concurrent allocate and free from 4 threads" << std::endl;
+    unsigned int wordSize = 8;
+    size_t numberOfWords = 65535;
+    MemoryManager memoryManager(wordSize, bestFit);
+    memoryManager.initialize(numberOfWords);
+    memoryManager.setConcurrent(true);
+
+    std::atomic<unsigned int> corrupted(0);
+    std::atomic<uint64_t> allocated(0);
+    std::vector<std::thread> threads;
+    for (uint64_t threadId = 1; threadId <= 4; ++threadId) {
+        threads.emplace_back([&memoryManager, &corrupted, &allocated, threadId]() {
+            std::vector<std::pair<uint64_t*, uint64_t>> live;
+            for (uint64_t i = 0; i < 5000; ++i) {
+                uint64_t words = 1 + (i * 7 + threadId) % 40; // Mix of cached and central sizes
+                uint64_t* block = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * words));
+                if (block) {
+                    std::fill(block, block + words, threadId << 32 | i);
+                    live.push_back(std::make_pair(block, words));
+                    ++allocated;
+                }
+                if (live.size() > 16 || (!block && !live.empty())) {
+                    auto oldest = live.front();
+                    for (uint64_t j = 0; j < oldest.second; ++j) {
+                        if (oldest.first[j] >> 32 != threadId) { ++corrupted; break; }
+                    }
+                    memoryManager.free(oldest.first);
+                    live.erase(live.begin());
+                }
+            }
+            for (auto block : live) { memoryManager.free(block.first); }
+        });
+    }
+    for (auto& thread : threads) { thread.join(); }
+
+    unsigned int score = 0;
+
+    std::cout << "Testing blocks were never shared between threads" << std::endl;
+    if (corrupted == 0) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+
+    // Exiting threads flush their caches, so everything should have coalesced back into one hole
+    std::vector<uint16_t> correctList = {0, 65535};
+    score += testGetList(memoryManager, correctList);
+
+    // Exited threads' caches are dropped, but what they counted is kept
+    MemoryStats stats = memoryManager.getStats();
+    std::cout << "Testing exited threads' counters" << std::endl;
+    if (stats.allocations == allocated && stats.frees == allocated) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+
+    memoryManager.shutdown();
+
+    return score;
+}
+
+
+unsigned int testPoolAllocator()
+{
+    std::cout << "Test Case: fixed-size pool allocator" << std::endl;
+    unsigned int wordSize = 8;
+    size_t numberOfWords = 256;
+    MemoryManager memoryManager(wordSize, bestFit);
+    memoryManager.initialize(numberOfWords);
+
+    unsigned int score = 0;
+    {
+        PoolAllocator<12, 16> pool(memoryManager); // 12 bytes round up to 2 words, so 32 words per slab
+
+        std::vector<void*> blocks;
+        for (int i = 0; i < 20; ++i) {
+            blocks.push_back(pool.allocate());
+        }
+
+        std::cout << "Testing slabs after 20 allocations" << std::endl;
+        std::cout << "Expected: 2" << std::endl;
+        std::cout << "Got:" << pool.getSlabCount() << std::endl;
+        if (pool.getSlabCount() == 2 && blocks[1] == static_cast<char*>(blocks[0]) + 16) {
+            std::cout << "[CORRECT]\n" << std::endl;
+            ++score;
+        }
+        else {
+            std::cout << "[INCORRECT]\n" << std::endl;
+        }
+
+        // Emptying the second slab hands it back, the first one stays
+        for (int i = 16; i < 20; ++i) {
+            pool.free(blocks[i]);
+        }
+        pool.free(blocks[0]);
+
+        std::vector<uint16_t> correctList = {32, 224};
+        std::cout << "Testing Memory Manager state after the second slab empties" << std::endl;
+        score += testGetList(memoryManager, correctList);
+    }
+
+    memoryManager.shutdown();
+
+    return score;
+}
+
+
+unsigned int testBumpArena()
+{
+    std::cout << "Test Case: bump arena with nested scopes" << std::endl;
+    unsigned int wordSize = 8;
+    size_t numberOfWords = 16;
+    MemoryManager memoryManager(wordSize, bestFit);
+    memoryManager.initialize(numberOfWords);
+
+    unsigned int score = 0;
+    {
+        BumpArena arena(memoryManager, 64);
+        void* first = arena.allocate(10); // Rounds up to 16 bytes
+
+        std::vector<size_t> used;
+        {
+            ArenaScope outer(arena);
+            arena.allocate(8);
+            {
+                ArenaScope inner(arena);
+                arena.allocate(16);
+                used.push_back(arena.getUsed()); // 40
+            }
+            used.push_back(arena.getUsed()); // 24
+            used.push_back(arena.allocate(48) == nullptr); // Only 40 bytes left
+        }
+        used.push_back(arena.getUsed()); // 16
+        used.push_back(arena.allocate(8) == static_cast<char*>(first) + 16);
+        arena.reset();
+        used.push_back(arena.getUsed()); // 0
+
+        std::vector<size_t> correctUsed = {40, 24, 1, 16, 1, 0};
+        std::cout << "Testing arena usage through the scopes" << std::endl;
+        if (used == correctUsed) {
+            std::cout << "[CORRECT]\n" << std::endl;
+            ++score;
+        }
+        else {
+            std::cout << "[INCORRECT]\n" << std::endl;
+        }
+    }
+
+    // The arena's whole block went back to the memory manager with a single free
+    std::vector<uint16_t> correctList = {0, 16};
+    score += testGetList(memoryManager, correctList);
+
+    memoryManager.shutdown();
+
+    return score;
+}
+
+
+unsigned int testBuddyEngine()
+{
+    std::cout << "Test Case: buddy engine" << std::endl;
+    unsigned int wordSize = 8;
+    size_t numberOfWords = 24; // Starts out as buddy blocks [0, 16] and [16, 8]
+    MemoryManager memoryManager(wordSize, Engine::Buddy);
+    memoryManager.initialize(numberOfWords);
+
+    std::cout << "Allocating 3 words and 5 words" << std::endl;
+    uint64_t* testArray1 = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 3)); // 4 words at 16
+    uint64_t* testArray2 = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 5)); // 8 words at 0
+
+    std::vector<uint8_t> correctBitmap{0xFF, 0x00, 0x0F};
+    std::vector<uint16_t> correctList = {8, 8, 20, 4};
+
+    unsigned int score = 0;
+
+    std::cout << "Testing Memory Manager state\n" << std::endl;
+    score += testGetBitmap(memoryManager, correctBitmap);
+    score += testGetList(memoryManager, correctList);
+    score += testDumpMemoryMap(memoryManager, "testBuddyEngine.txt", vectorToString(correctList));
+    MemoryStats stats = memoryManager.getStats();
+    bool allocatedStats = stats.holeCount == 2 && stats.largestHole == 8 * 8;
+
+    // Freeing merges each block with its buddy, ending up back at the initial blocks
+    memoryManager.free(testArray1);
+    memoryManager.free(testArray2);
+
+    std::vector<uint8_t> correctBitmapAfterFree{0x00, 0x00, 0x00};
+    std::vector<uint16_t> correctListAfterFree = {0, 24};
+
+    std::cout << "Testing Memory Manager state after freeing\n" << std::endl;
+    score += testGetBitmap(memoryManager, correctBitmapAfterFree);
+    score += testGetList(memoryManager, correctListAfterFree);
+
+    // The free blocks [0, 16] and [16, 8] are one hole, but only a whole block can be handed out
+    stats = memoryManager.getStats();
+    std::cout << "Testing buddy engine statistics" << std::endl;
+    if (allocatedStats && stats.holeCount == 1 && stats.largestHole == 16 * 8) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+
+    memoryManager.shutdown();
+
+    return score;
+}
+
+
+unsigned int testAllocateAligned()
+{
+    std::cout << "Test Case: cache-line aligned allocation" << std::endl;
+    unsigned int wordSize = 4;
+    size_t numberOfWords = 96;
+    MemoryManager memoryManager(wordSize, bestFit);
+    memoryManager.initialize(numberOfWords);
+
+    memoryManager.allocate(sizeof(uint32_t) * 3);
+    uint32_t* testArray = static_cast<uint32_t*>(memoryManager.allocateAligned(sizeof(uint32_t) * 4, 64));
+
+    unsigned int score = 0;
+
+    std::cout << "Testing address is 64-byte aligned" << std::endl;
+    if (testArray && reinterpret_cast<uintptr_t>(testArray) % 64 == 0) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+
+    // The 13 words of padding before the block stay a hole
+    std::vector<uint16_t> correctList = {3, 13, 20, 76};
+    score += testGetList(memoryManager, correctList);
+    memoryManager.shutdown();
+
+    MemoryManager buddyManager(8, Engine::Buddy);
+    buddyManager.initialize(64);
+    buddyManager.allocate(8);
+    uint64_t* buddyArray = static_cast<uint64_t*>(buddyManager.allocateAligned(8, 64)); // Needs an 8 word block
+
+    std::cout << "Testing buddy engine address is 64-byte aligned" << std::endl;
+    if (buddyArray && reinterpret_cast<uintptr_t>(buddyArray) % 64 == 0) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    buddyManager.shutdown();
+
+    return score;
+}
+
+
+unsigned int testReallocate()
+{
+    std::cout << "Test Case: in-place reallocate" << std::endl;
+    unsigned int wordSize = 8;
+    size_t numberOfWords = 32;
+    MemoryManager memoryManager(wordSize, firstFit);
+    memoryManager.initialize(numberOfWords);
+
+    uint64_t* testArray = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t) * 4));
+    memoryManager.free(memoryManager.allocate(sizeof(uint64_t) * 4));
+    for (uint64_t i = 0; i < 4; ++i) { testArray[i] = i + 1; }
+
+    unsigned int score = 0;
+
+    // Grows into the hole right after the block
+    uint64_t* grownArray = static_cast<uint64_t*>(memoryManager.reallocate(testArray, sizeof(uint64_t) * 8));
+    std::cout << "Testing grown block did not move" << std::endl;
+    if (grownArray == testArray) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+
+    // Shrinking splits the tail off, and it merges with the hole after it
+    memoryManager.reallocate(testArray, sizeof(uint64_t) * 2);
+    std::vector<uint16_t> correctList = {2, 30};
+    score += testGetList(memoryManager, correctList);
+
+    // A block in the way forces a move, which keeps the contents
+    memoryManager.allocate(sizeof(uint64_t) * 4);
+    uint64_t* movedArray = static_cast<uint64_t*>(memoryManager.reallocate(testArray, sizeof(uint64_t) * 6));
+    std::cout << "Testing moved block kept its contents" << std::endl;
+    if (movedArray == testArray + 6 && movedArray[0] == 1 && movedArray[1] == 2) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    memoryManager.shutdown();
+
+    MemoryManager buddyManager(8, Engine::Buddy);
+    buddyManager.initialize(64);
+    void* buddyArray = buddyManager.allocate(8);
+
+    std::cout << "Testing buddy engine grows into free buddies" << std::endl;
+    if (buddyArray && buddyManager.reallocate(buddyArray, 32) == buddyArray) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    buddyManager.shutdown();
+
+    return score;
+}
+
+
+unsigned int testBatchAllocate()
+{
+    std::cout << "Test Case: batched allocate and free" << std::endl;
+    unsigned int wordSize = 8;
+    size_t numberOfWords = 64;
+    MemoryManager memoryManager(wordSize, firstFit);
+    memoryManager.initialize(numberOfWords);
+
+    void* blocks[10];
+    unsigned int score = 0;
+
+    std::cout << "Testing burst is carved from one hole" << std::endl;
+    if (memoryManager.allocateMany(10, 16, blocks) == 10 && blocks[9] == static_cast<char*>(blocks[0]) + 18 * 8) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+
+    // Frees out of order, with a repeat and an address that was never allocated
+    int notAllocated;
+    void* batch[] = {blocks[3], blocks[1], &notAllocated, blocks[2], blocks[3]};
+    memoryManager.freeMany(batch, 5);
+    std::vector<uint16_t> correctList = {2, 6, 20, 44};
+    score += testGetList(memoryManager, correctList);
+
+    void* rest[] = {blocks[0], blocks[4], blocks[5], blocks[6], blocks[7], blocks[8], blocks[9]};
+    memoryManager.freeMany(rest, 7);
+    correctList = {0, 64};
+    score += testGetList(memoryManager, correctList);
+
+    void* tooMany[100];
+    std::cout << "Testing burst stops when memory runs out" << std::endl;
+    if (memoryManager.allocateMany(100, 8 * 8, tooMany) == 8) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    memoryManager.shutdown();
+
+    return score;
+}
+
+
+// Picks the last hole that fits, to check that policies other than the built-in ones are called
+struct LastFitPolicy {
+    static int select(int sizeInWords, void* list)
+    {
+        uint16_t* holeList = static_cast<uint16_t*>(list);
+        int wordOffset = -1;
+        for (uint16_t i = 0; i < holeList[0]; ++i) {
+            if (holeList[2 + i * 2] >= sizeInWords) {
+                wordOffset = holeList[1 + i * 2];
+            }
+        }
+        return wordOffset;
+    }
+};
+
+// Leaves holes of 10, 20 and 26 words at offsets 0, 14 and 38
+template <typename Policy>
+void fragmentForPolicy(BasicMemoryManager<Policy>& memoryManager)
+{
+    memoryManager.initialize(64);
+    void* first = memoryManager.allocate(10 * 8);
+    memoryManager.allocate(4 * 8);
+    void* third = memoryManager.allocate(20 * 8);
+    memoryManager.allocate(4 * 8);
+    memoryManager.free(first);
+    memoryManager.free(third);
+}
+
+unsigned int testPolicyTemplate()
+{
+    std::cout << "Test Case: compile-time fit policies" << std::endl;
+    unsigned int score = 0;
+
+    BasicMemoryManager<BestFitPolicy> bestFitManager(8);
+    fragmentForPolicy(bestFitManager);
+    bestFitManager.allocate(8 * 8);
+    std::vector<uint16_t> correctList = {8, 2, 14, 20, 38, 26};
+    score += testGetList(bestFitManager, correctList);
+
+    // The inlined allocate() still keeps the statistics
+    bestFitManager.allocate(30 * 8); // No hole is that large
+    bestFitManager.setLatencySampling(true);
+    bestFitManager.allocate(8);
+    MemoryStats stats = bestFitManager.getStats();
+    uint64_t allocateSamples = 0;
+    for (unsigned i = 0; i < MemoryStats::latencyBucketCount; ++i) { allocateSamples += stats.allocateTicks[i]; }
+    std::cout << "Testing compile-time policy statistics" << std::endl;
+    if (stats.allocations == 6 && stats.failures == 1 && stats.sizeClasses[6] == 1 && allocateSamples == 1) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    bestFitManager.shutdown();
+
+    BasicMemoryManager<WorstFitPolicy> worstFitManager(8);
+    fragmentForPolicy(worstFitManager);
+    char* worstFitArray = static_cast<char*>(worstFitManager.allocate(8 * 8));
+    std::cout << "Testing worst fit policy picks the largest hole" << std::endl;
+    if (worstFitArray == static_cast<char*>(worstFitManager.getMemoryStart()) + 38 * 8) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    worstFitManager.shutdown();
+
+    BasicMemoryManager<LastFitPolicy> lastFitManager(8);
+    fragmentForPolicy(lastFitManager);
+    char* lastFitArray = static_cast<char*>(lastFitManager.allocate(12 * 8));
+    std::cout << "Testing custom policy is used" << std::endl;
+    if (lastFitArray == static_cast<char*>(lastFitManager.getMemoryStart()) + 38 * 8) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    lastFitManager.shutdown();
+
+    return score;
+}
+
+
+unsigned int testGrowableArena()
+{
+    std::cout << "Test Case: growable arena" << std::endl;
+    unsigned int wordSize = 8;
+    GrowableMemoryManager memoryManager(wordSize, firstFit);
+    memoryManager.initialize(16);
+
+    uint64_t* testArray = static_cast<uint64_t*>(memoryManager.allocate(16 * 8));
+    for (uint64_t i = 0; i < 16; ++i) { testArray[i] = i; }
+    void* secondRegionArray = memoryManager.allocate(8 * 8);
+    void* bigArray = memoryManager.allocate(40 * 8); // Bigger than a region, gets a region of its own
+
+    unsigned int score = 0;
+
+    std::cout << "Testing full arena grows by a region per exhaustion" << std::endl;
+    if (secondRegionArray && bigArray && memoryManager.getRegionCount() == 3) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+
+    std::cout << "Testing growth leaves earlier blocks in place" << std::endl;
+    if (memoryManager.getRegion(testArray) != memoryManager.getRegion(secondRegionArray) && testArray[15] == 15) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+
+    memoryManager.free(bigArray);
+    memoryManager.free(secondRegionArray);
+    memoryManager.free(testArray);
+    std::cout << "Testing empty regions are released" << std::endl;
+    if (memoryManager.getRegionCount() == 1) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    memoryManager.shutdown();
+
+    return score;
+}
+
+
+unsigned int testMappedArena()
+{
+    std::cout << "Test Case: mapped arena" << std::endl;
+    unsigned int wordSize = 8;
+    size_t numberOfWords = 1 << 19; // 4MB, two huge pages
+    MemoryManager memoryManager(wordSize, bestFit, OffsetWidth::Bits32);
+
+    ArenaOptions options;
+    options.hugePages = HugePages::Transparent;
+    options.numaNode = 0;
+    memoryManager.initialize(numberOfWords, options);
+    uint64_t* testArray = static_cast<uint64_t*>(memoryManager.allocate(numberOfWords * wordSize));
+
+    unsigned int score = 0;
+
+    std::cout << "Testing arena is huge page aligned and zeroed" << std::endl;
+    if (testArray && reinterpret_cast<uintptr_t>(testArray) % (2 << 20) == 0 && testArray[0] == 0
+        && testArray[numberOfWords - 1] == 0) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    memoryManager.shutdown();
+
+    // Falls back to transparent huge pages when none are reserved
+    options.hugePages = HugePages::Explicit;
+    options.numaNode = -1;
+    memoryManager.initialize(numberOfWords, options);
+    testArray = static_cast<uint64_t*>(memoryManager.allocate(sizeof(uint64_t)));
+
+    std::cout << "Testing explicit huge page arena" << std::endl;
+    if (testArray && memoryManager.getMemoryLimit() == numberOfWords * wordSize) {
+        testArray[0] = 1;
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    memoryManager.shutdown();
+
+    // A 512MB mapped arena, whose partition table and bitmap would take another 264MB if filled up front
+    std::cout << "Testing mapped arena bookkeeping is touched lazily" << std::endl;
+    long pageBytes = sysconf(_SC_PAGESIZE);
+    long residentBefore = 0, residentAfter = 0, pages = 0;
+    std::ifstream("/proc/self/statm") >> pages >> residentBefore;
+    options = ArenaOptions();
+    options.mapped = true;
+    memoryManager.initialize(size_t(1) << 26, options);
+    void* block = memoryManager.allocate(wordSize);
+    memoryManager.free(block);
+    std::ifstream("/proc/self/statm") >> pages >> residentAfter;
+    if (block != nullptr && (residentAfter - residentBefore) * pageBytes < (16 << 20)) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    memoryManager.shutdown();
+
+    return score;
+}
+
+
+// Copies the (offset, length) pairs out of getList(), without the leading count
+std::vector<uint16_t> readList(MemoryManager& memoryManager)
+{
+    uint16_t* list = static_cast<uint16_t*>(memoryManager.getList());
+    std::vector<uint16_t> pairs(list + 1, list + 1 + list[0] * 2);
+    delete [] list;
+    return pairs;
+}
+
+unsigned int testPersistentArena()
+{
+    std::cout << "Test Case: persistent arena" << std::endl;
+    const char* fileName = "testPersistentArena.bin";
+    unlink(fileName);
+    unsigned int wordSize = 8;
+    unsigned int score = 0;
+
+    {
+        MemoryManager firstAttach(wordSize, bestFit);
+        MemoryManager secondAttach(wordSize, bestFit);
+        firstAttach.attach(fileName, 64);
+        uint64_t* testArray = static_cast<uint64_t*>(firstAttach.allocate(10 * 8));
+        testArray[0] = 42;
+
+        // Attaching again sees the first block and allocates around it, and the first manager sees that block
+        secondAttach.attach(fileName, 64);
+        secondAttach.allocate(4 * 8);
+        std::vector<uint16_t> correctList = {14, 50};
+        score += testGetList(firstAttach, correctList);
+    }
+
+    MemoryManager reattach(wordSize, bestFit);
+    std::cout << "Testing reattached arena kept its blocks" << std::endl;
+    if (reattach.attach(fileName, 0) && static_cast<uint64_t*>(reattach.getMemoryStart())[0] == 42
+        && reattach.allocate(8) == static_cast<char*>(reattach.getMemoryStart()) + 14 * 8) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    reattach.shutdown();
+
+    MemoryManager wrongWordSize(4, bestFit);
+    std::cout << "Testing arena of another word size is refused" << std::endl;
+    if (!wrongWordSize.attach(fileName, 64)) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    unlink(fileName);
+
+    // Each manager catches up with the other's changes, from the log or, once it has fallen 300 changes behind, by a
+    // rebuild; either way both end up with the holes a private arena has after the same calls
+    {
+        MemoryManager firstAttach(wordSize, bestFit);
+        MemoryManager secondAttach(wordSize, bestFit);
+        MemoryManager privateArena(wordSize, bestFit);
+        firstAttach.attach(fileName, 1000);
+        secondAttach.attach(fileName, 1000);
+        privateArena.initialize(1000);
+        std::vector<void*> sharedBlocks, privateBlocks;
+        std::vector<MemoryManager*> owners; // Each manager maps the file at its own address
+        for (unsigned i = 0; i < 300; i++) {
+            if (i % 3 == 2) {
+                owners[i / 2]->free(sharedBlocks[i / 2]);
+                privateArena.free(privateBlocks[i / 2]);
+                continue;
+            }
+            owners.push_back((i < 20 || i >= 280) && i % 2 == 1 ? &secondAttach : &firstAttach);
+            sharedBlocks.push_back(owners.back()->allocate((i % 7 + 1) * 8));
+            privateBlocks.push_back(privateArena.allocate((i % 7 + 1) * 8));
+        }
+        std::vector<uint16_t> correctList = readList(privateArena);
+        std::cout << "Testing attached managers replay each other's changes" << std::endl;
+        if (readList(firstAttach) == correctList && readList(secondAttach) == correctList) {
+            std::cout << "[CORRECT]\n" << std::endl;
+            ++score;
+        }
+        else {
+            std::cout << "[INCORRECT]\n" << std::endl;
+        }
+    }
+    unlink(fileName);
+
+    // Alternating calls between two managers cost the same on a large arena as on a small one, as neither rebuilds
+    auto alternatingCost = [&](size_t numberOfWords) {
+        MemoryManager firstAttach(wordSize, bestFit);
+        MemoryManager secondAttach(wordSize, bestFit);
+        firstAttach.attach(fileName, numberOfWords);
+        secondAttach.attach(fileName, numberOfWords);
+        auto fastest = std::chrono::steady_clock::duration::max();
+        for (unsigned round = 0; round < 5; round++) {
+            auto start = std::chrono::steady_clock::now();
+            for (unsigned i = 0; i < 200; i++) {
+                firstAttach.free(firstAttach.allocate(8));
+                secondAttach.free(secondAttach.allocate(8));
+            }
+            fastest = std::min(fastest, std::chrono::steady_clock::now() - start);
+        }
+        unlink(fileName);
+        return fastest;
+    };
+    auto smallArenaCost = alternatingCost(64);
+    auto largeArenaCost = alternatingCost(65535);
+    std::cout << "Testing alternating managers do not rebuild the arena" << std::endl;
+    if (largeArenaCost < smallArenaCost * 8) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+
+    return score;
+}
+
+
+// Reads a whole dump file back as the little-endian uint32_t values of the binary formats
+std::vector<uint32_t> readBinaryDump(std::string fileName)
+{
+    std::ifstream testFile(fileName, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(testFile)), std::istreambuf_iterator<char>());
+    std::vector<uint32_t> values(contents.size() / 4);
+    memcpy(values.data(), contents.data(), values.size() * 4);
+    return values;
+}
+
+unsigned int testBinaryDump()
+{
+    std::cout << "Test Case: binary and incremental dumpMemoryMap" << std::endl;
+    unsigned int wordSize = 8;
+    size_t numberOfWords = 32;
+    MemoryManager memoryManager(wordSize, firstFit);
+    memoryManager.initialize(numberOfWords);
+
+    memoryManager.free(memoryManager.allocate(4 * 8));
+    memoryManager.allocate(4 * 8);
+    memoryManager.allocate(4 * 8);
+    memoryManager.free(memoryManager.getMemoryStart());
+    unsigned int score = 0;
+
+    std::string fileName = "testBinaryDump.bin";
+    memoryManager.dumpMemoryMap((char*)fileName.c_str(), DumpFormat::Binary);
+    std::cout << "Testing binary dump" << std::endl;
+    if (readBinaryDump(fileName) == std::vector<uint32_t>{2, 0, 4, 8, 24}) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+
+    // Only the hole that changed is written: [8, 24] is gone and [16, 16] is new
+    memoryManager.allocate(8 * 8);
+    std::string incrementalFileName = "testIncrementalDump.bin";
+    unlink(incrementalFileName.c_str());
+    memoryManager.dumpMemoryMap((char*)incrementalFileName.c_str(), DumpFormat::Incremental);
+    std::cout << "Testing incremental dump" << std::endl;
+    if (readBinaryDump(incrementalFileName) == std::vector<uint32_t>{1, 8, 24, 1, 16, 16}) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+
+    // The text dump replaces the longer binary dump rather than overwriting its start
+    memoryManager.dumpMemoryMap((char*)fileName.c_str());
+    std::ifstream testFile(fileName);
+    std::string contents((std::istreambuf_iterator<char>(testFile)), std::istreambuf_iterator<char>());
+    std::cout << "Testing dump truncates the file" << std::endl;
+    if (contents == "[0, 4] - [16, 16]") {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    memoryManager.shutdown();
+    unlink(fileName.c_str());
+    unlink(incrementalFileName.c_str());
+
+    return score;
+}
+
+
+unsigned int testStats()
+{
+    std::cout << "Test Case: getStats" << std::endl;
+    unsigned int wordSize = 8;
+    size_t numberOfWords = 32;
+    MemoryManager memoryManager(wordSize, bestFit);
+    memoryManager.initialize(numberOfWords);
+
+    memoryManager.allocate(8);
+    void* freedArray = memoryManager.allocate(24);
+    memoryManager.allocate(64);
+    memoryManager.free(freedArray);
+    memoryManager.allocate(200); // 25 words, only 23 are free
+    MemoryStats stats = memoryManager.getStats();
+
+    unsigned int score = 0;
+
+    std::cout << "Testing allocation counters" << std::endl;
+    if (stats.allocations == 3 && stats.frees == 1 && stats.failures == 1 && stats.sizeClasses[3] == 1
+        && stats.sizeClasses[5] == 1 && stats.sizeClasses[6] == 1) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+
+    std::cout << "Testing bytes in use and peak" << std::endl;
+    if (stats.bytesInUse == 9 * 8 && stats.peakBytesInUse == 12 * 8) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+
+    // Holes are [1, 3] and [12, 20]
+    std::cout << "Testing hole figures" << std::endl;
+    if (stats.holeCount == 2 && stats.largestHole == 20 * 8 && std::abs(stats.fragmentation - 3.0 / 23) < 1e-9) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+
+    memoryManager.setLatencySampling(true);
+    memoryManager.free(memoryManager.allocate(8));
+    stats = memoryManager.getStats();
+    uint64_t allocateSamples = 0, freeSamples = 0;
+    for (unsigned i = 0; i < MemoryStats::latencyBucketCount; ++i) {
+        allocateSamples += stats.allocateTicks[i];
+        freeSamples += stats.freeTicks[i];
+    }
+    std::cout << "Testing latency histograms" << std::endl;
+    if (allocateSamples == 1 && freeSamples == 1) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    memoryManager.shutdown();
+
+    return score;
+}
+
+
+unsigned int testTraceRecording()
+{
+    std::cout << "Test Case: Trace recording" << std::endl;
+    const char* fileName = "testTraceRecording.bin";
+    unsigned int wordSize = 8;
+    MemoryManager memoryManager(wordSize, bestFit);
+    memoryManager.initialize(32);
+    void* first = memoryManager.allocate(16);
+    memoryManager.allocate(24);
+
+    unsigned int score = 0;
+    bool started = memoryManager.startTrace(fileName);
+    memoryManager.free(first); // Holes are now [0, 2] and [5, 27]
+    memoryManager.setAllocator(worstFit);
+    memoryManager.allocate(40); // 5 words carved from the hole at 5
+    memoryManager.allocate(200); // Fails, the largest hole is 22 words
+    uint64_t dropped = memoryManager.stopTrace();
+    memoryManager.allocate(8); // Not recorded
+
+    std::ifstream traceFile(fileName, std::ios::binary);
+    TraceHeader header;
+    traceFile.read((char*)&header, sizeof(header));
+    std::cout << "Testing trace header" << std::endl;
+    if (started && dropped == 0 && traceFile && std::string(header.magic, 8) == "MMTRACE1" && header.wordSize == 8
+        && header.recordSize == sizeof(TraceRecord)) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+
+    std::vector<TraceRecord> records;
+    TraceRecord record;
+    while (traceFile.read((char*)&record, sizeof(record))) { records.push_back(record); }
+    std::cout << "Testing trace records" << std::endl;
+    if (records.size() == 4
+        && records[0].event == TraceEvent::Free && records[0].offset == 0 && records[0].size == 16
+        && records[1].event == TraceEvent::SetAllocator && records[1].size == (uint64_t)FitPolicy::WorstFit
+        && records[2].event == TraceEvent::Allocate && records[2].offset == 5 && records[2].hole == 5
+        && records[2].size == 40
+        && records[3].event == TraceEvent::Allocate && records[3].offset == TraceRecord::noOffset
+        && records[3].size == 200
+        && records[1].timestamp <= records[2].timestamp && records[2].timestamp <= records[3].timestamp) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    memoryManager.shutdown();
+    std::remove(fileName);
+
+    return score;
+}
+
+unsigned int testMemoryResource()
+{
+    std::cout << "Test Case: pmr memory resource" << std::endl;
+    unsigned int wordSize = 8;
+    MemoryManager memoryManager(wordSize, bestFit, OffsetWidth::Bits32);
+    memoryManager.initialize(4096);
+    MemoryManagerResource resource(memoryManager);
+
+    unsigned int score = 0;
+    bool filled = true;
+    {
+        std::pmr::unordered_map<unsigned, std::pmr::vector<unsigned>> map(&resource);
+        for (unsigned i = 0; i < 100; ++i) {
+            map[i].assign(i % 7 + 1, i); // The inner vectors pick up the map's resource
+        }
+        for (unsigned i = 0; i < 100; ++i) {
+            filled = filled && map[i].size() == i % 7 + 1 && map[i].back() == i
+                && map[i].get_allocator().resource() == &resource;
+        }
+        filled = filled && !memoryManager.isEmpty();
+    }
+    std::cout << "Testing pmr containers" << std::endl;
+    if (filled && memoryManager.isEmpty()) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+
+    memoryManager.allocate(8); // Knock the next hole off any large boundary
+    void* aligned = resource.allocate(100, 256);
+    std::cout << "Testing alignment" << std::endl;
+    if ((uintptr_t)aligned % 256 == 0) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    resource.deallocate(aligned, 100, 256);
+
+    bool threw = false;
+    try {
+        aligned = resource.allocate(4096 * 8, 8); // More than the whole arena
+    }
+    catch (const std::bad_alloc&) {
+        threw = true;
+    }
+    MemoryManagerResource other(memoryManager);
+    std::cout << "Testing exhaustion and equality" << std::endl;
+    if (threw && resource.is_equal(other) && !resource.is_equal(*std::pmr::new_delete_resource())) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    memoryManager.shutdown();
+
+    return score;
+}
+
+unsigned int testSizedFree()
+{
+    std::cout << "Test Case: Sized free" << std::endl;
+    unsigned int wordSize = 8;
+    MemoryManager memoryManager(wordSize, bestFit);
+    memoryManager.initialize(32);
+    memoryManager.allocate(16);
+    void* middle = memoryManager.allocate(20); // 3 words
+    memoryManager.allocate(8);
+    memoryManager.free(middle, 20);
+
+    unsigned int score = 0;
+    std::vector<uint16_t> correctList = {2, 3, 6, 26};
+    score += testGetList(memoryManager, correctList);
+
+    // Buddy blocks are rounded up to a power of two, cached blocks take the thread cache path
+    MemoryManager buddyManager(wordSize, Engine::Buddy);
+    buddyManager.initialize(64);
+    void* buddyBlock = buddyManager.allocate(24);
+    buddyManager.free(buddyBlock, 24);
+    memoryManager.setConcurrent(true);
+    void* cached = memoryManager.allocate(40);
+    memoryManager.free(cached, 40);
+    bool reused = memoryManager.allocate(40) == cached;
+    memoryManager.free(cached, 40);
+    buddyManager.setConcurrent(true); // A cached 3-word request holds a 4-word block
+    buddyManager.free(buddyManager.allocate(24), 24);
+    buddyManager.setConcurrent(false);
+    std::cout << "Testing sized free on the buddy engine and in concurrent mode" << std::endl;
+    if (buddyManager.isEmpty() && reused && memoryManager.getStats().frees == 3) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    memoryManager.setConcurrent(false);
+    memoryManager.shutdown();
+    buddyManager.shutdown();
+
+    return score;
+}
+
+// Returns true if every handle's block still holds the two words written for it by testCompaction().
+bool handlesIntact(MemoryManager& memoryManager, const std::vector<Handle>& handles)
+{
+    for (size_t i = 0; i < handles.size(); ++i) {
+        if (handles[i] == 0) { continue; }
+        uint64_t* words = static_cast<uint64_t*>(memoryManager.pin(handles[i]));
+        bool intact = words[0] == i * 100 && words[1] == i * 100 + 1;
+        memoryManager.unpin(handles[i]);
+        if (!intact) { return false; }
+    }
+    return true;
+}
+
+unsigned int testCompaction()
+{
+    std::cout << "Test Case: Handles and compaction" << std::endl;
+    unsigned int wordSize = 8;
+    MemoryManager memoryManager(wordSize, bestFit);
+    memoryManager.initialize(32);
+
+    // Eight 2-word handles at 0-15, a fixed block at 16, another handle at 17-18
+    std::vector<Handle> handles;
+    for (unsigned i = 0; i < 8; ++i) { handles.push_back(memoryManager.allocateHandle(16)); }
+    memoryManager.allocate(8);
+    handles.push_back(memoryManager.allocateHandle(16));
+    for (size_t i = 0; i < handles.size(); ++i) {
+        uint64_t* words = static_cast<uint64_t*>(memoryManager.pin(handles[i]));
+        words[0] = i * 100;
+        words[1] = i * 100 + 1;
+        memoryManager.unpin(handles[i]);
+    }
+    for (unsigned i : {0, 2, 4}) {
+        memoryManager.freeHandle(handles[i]);
+        handles[i] = 0;
+    }
+    void* pinned = memoryManager.pin(handles[6]); // Holes are [0, 2], [4, 2], [8, 2] and [19, 13]
+
+    unsigned int score = 0;
+    bool finished = memoryManager.compact(std::chrono::microseconds(0)); // One step: handle 1 slides to 0
+    finished = !finished && memoryManager.compact(std::chrono::seconds(1));
+    std::vector<uint16_t> correctList = {6, 6, 19, 13}; // Handles 3 and 5 slid down, the pinned one kept its place
+    std::cout << "Testing compaction around pinned and fixed blocks" << std::endl;
+    if (finished && memoryManager.pin(handles[6]) == pinned && handlesIntact(memoryManager, handles)) {
+        score += testGetList(memoryManager, correctList);
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    memoryManager.unpin(handles[6]);
+    memoryManager.unpin(handles[6]);
+
+    finished = memoryManager.compact(std::chrono::seconds(1));
+    correctList = {10, 6, 19, 13}; // Handles 6 and 7 slid down too, handle 8 is stuck behind the fixed block
+    std::cout << "Testing compaction after unpinning" << std::endl;
+    if (finished && memoryManager.pin(handles[6]) != pinned && handlesIntact(memoryManager, handles)) {
+        score += testGetList(memoryManager, correctList);
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    memoryManager.unpin(handles[6]);
+
+    Handle freed = handles[1];
+    memoryManager.freeHandle(freed);
+    bool invalidated = memoryManager.pin(freed) == nullptr;
+    Handle reused = memoryManager.allocateHandle(8);
+    std::cout << "Testing handle reuse" << std::endl;
+    if (invalidated && reused == freed && memoryManager.allocateHandle(200) == 0) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    memoryManager.shutdown();
+
+    return score;
+}
+
+unsigned int testDeferredFree()
+{
+    std::cout << "Test Case: Deferred free" << std::endl;
+    unsigned int wordSize = 8;
+    MemoryManager memoryManager(wordSize, bestFit);
+    memoryManager.initialize(32);
+    memoryManager.setDeferredFree(true);
+    void* first = memoryManager.allocate(16);
+    void* second = memoryManager.allocate(16);
+    memoryManager.allocate(8);
+    memoryManager.free(first);
+    memoryManager.free(second);
+
+    unsigned int score = 0;
+    std::cout << "Testing same-size reuse from the quick list" << std::endl;
+    MemoryStats stats = memoryManager.getStats();
+    if (stats.holeCount == 1 && stats.largestHole == 27 * 8 && memoryManager.allocate(16) == second) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+
+    // The only hole is taken, so the next allocation has to merge the queued blocks at 0 and 2
+    memoryManager.free(second);
+    memoryManager.allocate(27 * 8);
+    std::cout << "Testing merge on allocation failure" << std::endl;
+    if (memoryManager.allocate(32) == first) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+
+    memoryManager.initialize(300);
+    std::vector<void*> blocks;
+    for (unsigned i = 0; i < 300; ++i) { blocks.push_back(memoryManager.allocate(8)); }
+    for (unsigned i = 0; i + 1 < MemoryManager::deferredFreeLimit; ++i) { memoryManager.free(blocks[i]); }
+    bool queued = memoryManager.getStats().holeCount == 0;
+    memoryManager.free(blocks[MemoryManager::deferredFreeLimit - 1]);
+    stats = memoryManager.getStats();
+    bool merged = stats.holeCount == 1 && stats.largestHole == MemoryManager::deferredFreeLimit * 8;
+    memoryManager.free(blocks[MemoryManager::deferredFreeLimit]);
+    memoryManager.setDeferredFree(false);
+    stats = memoryManager.getStats();
+    std::cout << "Testing merge at the queue limit and when switched off" << std::endl;
+    if (queued && merged && stats.holeCount == 1 && stats.largestHole == (MemoryManager::deferredFreeLimit + 1) * 8) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    memoryManager.shutdown();
+
+    // The inlined allocate() of a compile-time policy reuses and merges deferred frees too, and a persistent arena
+    // cannot be attached while frees are deferred, as they would never reach its file
+    BasicMemoryManager<FirstFitPolicy> basicManager(wordSize);
+    basicManager.initialize(64);
+    basicManager.setDeferredFree(true);
+    void* whole = basicManager.allocate(64 * 8);
+    basicManager.free(whole);
+    bool reused = basicManager.allocate(64 * 8) == whole;
+    basicManager.free(whole);
+    const char* fileName = "testDeferredFree.bin";
+    unlink(fileName);
+    std::cout << "Testing deferred free with a compile-time policy and a persistent arena" << std::endl;
+    if (reused && basicManager.allocate(8) == whole && !basicManager.attach(fileName, 64)) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    basicManager.shutdown();
+    unlink(fileName);
+
+    return score;
+}
+
+unsigned int testTLSFEngine()
+{
+    std::cout << "Test Case: TLSF engine" << std::endl;
+    unsigned int wordSize = 8;
+    MemoryManager memoryManager(wordSize, Engine::TLSF);
+    memoryManager.initialize(64);
+
+    void* first = memoryManager.allocate(24); // Blocks are split exactly: [0, 3], [3, 5], [8, 2]
+    void* second = memoryManager.allocate(40);
+    void* third = memoryManager.allocate(16);
+    memoryManager.free(second);
+
+    unsigned int score = 0;
+    std::vector<uint16_t> correctList = {3, 5, 10, 54};
+    score += testGetList(memoryManager, correctList);
+
+    memoryManager.free(first); // Merges with the free block after it
+    memoryManager.free(third); // Merges with the free blocks on both sides
+    correctList = {0, 64};
+    score += testGetList(memoryManager, correctList);
+
+    // Random traffic with aligned blocks and resizes, checking every block's contents survive until it is freed
+    memoryManager.initialize(4096);
+    std::vector<std::pair<uint64_t*, size_t>> live;
+    unsigned seed = 1;
+    bool intact = true;
+    for (unsigned i = 0; i < 4000; ++i) {
+        seed = seed * 1103515245 + 12345;
+        if (live.empty() || (seed >> 16) % 3 != 0) {
+            size_t words = (seed >> 8) % 40 + 1;
+            uint64_t* block = static_cast<uint64_t*>((i % 5 == 0) ? memoryManager.allocateAligned(words * 8, 64)
+                : memoryManager.allocate(words * 8));
+            if (block == nullptr) { continue; }
+            intact = intact && (i % 5 != 0 || (uintptr_t)block % 64 == 0);
+            if (i % 7 == 0) { // Grow or shrink in place where possible
+                size_t resized = (seed >> 4) % 40 + 1;
+                uint64_t* moved = static_cast<uint64_t*>(memoryManager.reallocate(block, resized * 8));
+                if (moved != nullptr) {
+                    block = moved;
+                    words = resized;
+                }
+            }
+            for (size_t j = 0; j < words; ++j) { block[j] = (uintptr_t)block + j; }
+            live.push_back({block, words});
+        }
+        else {
+            size_t index = (seed >> 8) % live.size();
+            for (size_t j = 0; j < live[index].second; ++j) {
+                intact = intact && live[index].first[j] == (uintptr_t)live[index].first + j;
+            }
+            memoryManager.free(live[index].first);
+            live[index] = live.back();
+            live.pop_back();
+        }
+    }
+    for (auto& block : live) { memoryManager.free(block.first); }
+    std::cout << "Testing random traffic" << std::endl;
+    MemoryStats stats = memoryManager.getStats();
+    if (intact && memoryManager.isEmpty() && stats.holeCount == 1 && stats.largestHole == 4096 * 8) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+
+    // Requests the rounded class search misses: the whole arena, and free blocks just past a class boundary
+    memoryManager.initialize(1000);
+    std::cout << "Testing allocations that fill free blocks exactly" << std::endl;
+    void* whole = memoryManager.allocate(1000 * 8);
+    bool filled = whole != nullptr;
+    memoryManager.free(whole);
+    void* most = memoryManager.allocate(995 * 8);
+    void* rest = memoryManager.allocate(5 * 8);
+    filled = filled && most != nullptr && rest != nullptr && memoryManager.getStats().holeCount == 0;
+    memoryManager.free(most);
+    memoryManager.free(rest);
+    void* front = memoryManager.allocate(455 * 8); // Leaves a free block of 545 words, just past the 544 boundary
+    void* back = memoryManager.allocate(545 * 8);
+    filled = filled && front != nullptr && back != nullptr && memoryManager.allocate(8) == nullptr;
+    memoryManager.free(front);
+    memoryManager.free(back);
+    if (filled && memoryManager.isEmpty()) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    memoryManager.shutdown();
+
+    return score;
+}
+
+unsigned int testStaticMemoryManager()
+{
+    std::cout << "Test Case: StaticMemoryManager" << std::endl;
+    static StaticMemoryManager<8, 32> staticManager; // Constant-initialized, no constructor runs
+    static_assert(StaticMemoryManager<8, 32>::getMemoryLimit() == 256, "Arena size is known at compile time");
+    MemoryManager memoryManager(8, bestFit);
+    memoryManager.initialize(32);
+    for (size_t size : {16, 24, 8, 40}) {
+        staticManager.allocate(size);
+        memoryManager.allocate(size);
+    }
+    staticManager.free((char*)staticManager.getMemoryStart() + 16);
+    memoryManager.free((char*)memoryManager.getMemoryStart() + 16);
+
+    unsigned int score = 0;
+    uint16_t list[16];
+    size_t listBytes = staticManager.getList(list, sizeof(list));
+    std::vector<uint16_t> correctList = {2, 2, 3, 11, 21};
+    std::cout << "Testing getList into a caller buffer" << std::endl;
+    bool listMatches = std::equal(correctList.begin(), correctList.end(), list);
+    if (listBytes == correctList.size() * sizeof(uint16_t) && listMatches) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+
+    uint8_t bitmap[StaticMemoryManager<8, 32>::getBitmapBytes()];
+    uint8_t* correctBitmap = static_cast<uint8_t*>(memoryManager.getBitmap());
+    std::cout << "Testing getBitmap matches MemoryManager" << std::endl;
+    if (staticManager.getBitmap(bitmap, sizeof(bitmap)) == sizeof(bitmap)
+        && std::memcmp(bitmap, correctBitmap, sizeof(bitmap)) == 0) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    delete [] correctBitmap;
+    memoryManager.shutdown();
+
+    StaticMemoryManager<4, 64, FitPolicy::WorstFit> stackManager;
+    stackManager.allocate(8);
+    void* middle = stackManager.allocate(8);
+    stackManager.allocate(200); // Words 4 to 53, leaving [2, 2] and [54, 10] once middle is freed
+    stackManager.free(middle);
+    bool worst = stackManager.allocate(4) == (char*)stackManager.getMemoryStart() + 54 * 4;
+    bool full = stackManager.allocate(256) == nullptr && stackManager.getList(list, 4) == 0;
+    stackManager.reset();
+    std::cout << "Testing fit policy, small buffers and reset" << std::endl;
+    if (worst && full && stackManager.isEmpty() && stackManager.allocate(256) == stackManager.getMemoryStart()) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+
+    return score;
+}
+
+unsigned int testCallerBuffers()
+{
+    std::cout << "Test Case: getList and getBitmap into caller buffers" << std::endl;
+    unsigned int score = 0;
+
+    for (OffsetWidth offsetWidth : {OffsetWidth::Bits16, OffsetWidth::Bits32}) {
+        MemoryManager memoryManager(8, bestFit, offsetWidth);
+        bool unallocated = memoryManager.getListBytes() == 0 && memoryManager.getBitmapBytes() == 0;
+        memoryManager.initialize(70);
+        memoryManager.allocate(16);
+        void* freed = memoryManager.allocate(24);
+        memoryManager.allocate(8);
+        memoryManager.free(freed); // Holes are [2, 3] and [6, 64]
+
+        uint8_t buffer[64];
+        size_t listBytes = memoryManager.getList(buffer, sizeof(buffer));
+        uint8_t* list = static_cast<uint8_t*>(memoryManager.getList());
+        bool listMatches = listBytes == memoryManager.getListBytes() && std::memcmp(buffer, list, listBytes) == 0;
+        bool tooSmall = memoryManager.getList(buffer, listBytes - 1) == 0
+            && memoryManager.getBitmap(buffer, memoryManager.getBitmapBytes() - 1) == 0;
+        size_t bitmapBytes = memoryManager.getBitmap(buffer, sizeof(buffer));
+        uint8_t* bitmap = static_cast<uint8_t*>(memoryManager.getBitmap());
+        bool bitmapMatches = bitmapBytes == memoryManager.getBitmapBytes()
+            && std::memcmp(buffer, bitmap, bitmapBytes) == 0;
+
+        unsigned entryBytes = (offsetWidth == OffsetWidth::Bits32) ? 4 : 2;
+        std::cout << "Testing " << entryBytes * 8 << "-bit layouts" << std::endl;
+        if (unallocated && listMatches && tooSmall && bitmapMatches && listBytes == 5 * entryBytes
+            && bitmapBytes == entryBytes + 9) {
+            std::cout << "[CORRECT]\n" << std::endl;
+            ++score;
+        }
+        else {
+            std::cout << "[INCORRECT]\n" << std::endl;
+        }
+        delete [] list;
+        delete [] bitmap;
+        memoryManager.shutdown();
+    }
+
+    return score;
+}
+
+unsigned int testMemoryManagerPool()
+{
+    std::cout << "Test Case: MemoryManagerPool" << std::endl;
+    MemoryManagerPool pool(8, bestFit);
+    pool.initialize(64, 2);
+
+    unsigned int score = 0;
+    int cpuBefore = sched_getcpu();
+    void* block = pool.allocate(8);
+    int cpuAfter = sched_getcpu(); // The thread may have migrated in between
+    std::cout << "Testing per-CPU arena selection" << std::endl;
+    if (pool.getArenaCount() == 2 && (pool.getArena(block) == pool.getArenaForCpu(cpuBefore)
+        || pool.getArena(block) == pool.getArenaForCpu(cpuAfter))) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+
+    // 128 words in all, so the home arena fills up and the rest spill over to the other one
+    std::vector<void*> blocks = {block};
+    for (unsigned i = 1; i < 128; ++i) { blocks.push_back(pool.allocate(8)); }
+    bool spilled = std::find(blocks.begin(), blocks.end(), nullptr) == blocks.end() && pool.allocate(8) == nullptr;
+    std::cout << "Testing spill-over between arenas" << std::endl;
+    if (spilled && pool.getArena(blocks.front()) != pool.getArena(blocks.back())) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+
+    // Blocks of the arena a thread is not running on go back through the owner's remote-free stack
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < 4; ++t) {
+        threads.emplace_back([&pool, &blocks, t]() {
+            for (size_t i = t; i < blocks.size(); i += 4) { pool.free(blocks[i]); }
+        });
+    }
+    for (auto& thread : threads) { thread.join(); }
+    pool.flushRemoteFrees();
+    std::cout << "Testing cross-arena frees" << std::endl;
+    if (pool.getArenaForCpu(0)->isEmpty() && pool.getArenaForCpu(1)->isEmpty() && pool.allocate(64 * 8) != nullptr) {
+        std::cout << "[CORRECT]\n" << std::endl;
+        ++score;
+    }
+    else {
+        std::cout << "[INCORRECT]\n" << std::endl;
+    }
+    pool.shutdown();
+
+    return score;
+}
+
 std::string vectorToString(const std::vector<uint16_t>& vector)
 {
     std::string vectorString = "";
 
     vectorString += "[" + std::to_string(vector[0]) + ", " + std::to_string(vector[1]);
-    for (int i = 2; i < vector.size(); i +=2)
+    for (size_t i = 2; i < vector.size(); i +=2)
     {
         vectorString += "] - [" + std::to_string(vector[i]) + ", " + std::to_string(vector[i + 1]);
     }
@@ -619,7 +2246,7 @@ std::string vectorToString(const std::vector<uint16_t>& vector)
 }
 
 
-unsigned int testGetBitmap(MemoryManager& memoryManager, uint16_t correctBitmapLength, std::vector<uint8_t> correctBitmap)
+unsigned int testGetBitmap(MemoryManager& memoryManager, std::vector<uint8_t> correctBitmap)
 {
     unsigned int score = 0;
     uint8_t* bitmap = static_cast<uint8_t*>(memoryManager.getBitmap());
@@ -662,7 +2289,7 @@ unsigned int testGetBitmap(MemoryManager& memoryManager, uint16_t correctBitmapL
 }
 
 
-unsigned int testGetList(MemoryManager& memoryManager, uint16_t correctListLength, std::vector<uint16_t> correctList)
+unsigned int testGetList(MemoryManager& memoryManager, std::vector<uint16_t> correctList)
 {
     unsigned int score = 0;
     std::cout << std::dec << std::endl;
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "MemoryManager.h"
+#include <type_traits>
+
+// Compile-time fit policies for BasicMemoryManager. Each names its allocator function as select, so the base memory
+// manager still recognizes it and keeps the structures that policy searches (the size index for bestFit/worstFit).
+struct BestFitPolicy { static constexpr int (*select)(int, void*) = bestFit; };
+struct WorstFitPolicy { static constexpr int (*select)(int, void*) = worstFit; };
+struct FirstFitPolicy { static constexpr int (*select)(int, void*) = firstFit; };
+struct NextFitPolicy { static constexpr int (*select)(int, void*) = nextFit; };
+
+// Memory manager whose fit policy is fixed at compile time. allocate() runs the policy's search directly, without
+// the std::function call or the runtime policy switch, so the search can be inlined into it. Any other Policy type
+// must provide a static int select(int sizeInWords, void* list) that works like an allocator function; it is called
+// directly rather than through type erasure. Statistics and everything else behave exactly like MemoryManager, which
+// remains the runtime-pluggable manager for callers that need setAllocator().
+template <typename Policy>
+class BasicMemoryManager : public MemoryManager {
+    public:
+        // Constructor - Sets native word size (in bytes, for alignment) and the offset width of getList() and
+        // getBitmap().
+        BasicMemoryManager(unsigned wordSize, OffsetWidth offsetWidth = OffsetWidth::Bits16);
+
+        // Allocates a memory block using the fit policy. If no memory is available or size is invalid, returns nullptr.
+        void* allocate(size_t sizeInBytes);
+
+        // The policy is part of the type, so it cannot be swapped at runtime.
+        void setAllocator(function<int(int, void*)> allocator) = delete;
+
+    private:
+        // Returns the word offset the policy picks for sizeInWords words, or -1 if no hole fits.
+        int selectHole(unsigned sizeInWords);
+};
+
+// Constructor - Sets native word size (in bytes, for alignment) and the offset width of getList() and getBitmap().
+template <typename Policy>
+BasicMemoryManager<Policy>::BasicMemoryManager(unsigned wordSize, OffsetWidth offsetWidth)
+    : MemoryManager(wordSize, Policy::select, offsetWidth) {}
+
+// Allocates a memory block using the fit policy. If no memory is available or size is invalid, returns nullptr.
+template <typename Policy>
+void* BasicMemoryManager<Policy>::allocate(size_t sizeInBytes) {
+    // Slow paths, including latency sampling, which times the whole call, and deferred frees, which are reused first
+    if (concurrent || shared != nullptr || tracer || deferFrees || latencySampling.load(memory_order_relaxed)) {
+        return MemoryManager::allocate(sizeInBytes);
+    }
+
+    // Check for invalid allocation
+    if (sizeInBytes > memSize*wordSize || sizeInBytes == 0 || memoryBytes == 0) { return nullptr; }
+
+    unsigned words = (sizeInBytes + wordSize - 1) / wordSize; // Round up to whole words
+
+    int holeSelected = selectHole(words);
+    // No hole can fit allocation, or the policy picked words that are not free
+    void* block = (holeSelected != -1 && claim(holeSelected, words)) ? &memory[(size_t)holeSelected*wordSize] : nullptr;
+    countAllocations(counters, sizeInBytes, block != nullptr, block == nullptr);
+    return block;
+}
+
+// Returns the word offset the policy picks for sizeInWords words, or -1 if no hole fits.
+template <typename Policy>
+int BasicMemoryManager<Policy>::selectHole(unsigned sizeInWords) {
+    if constexpr (is_same<Policy, BestFitPolicy>::value || is_same<Policy, WorstFitPolicy>::value) {
+        return findIndexedHole(sizeInWords, 1);
+    }
+    else if constexpr (is_same<Policy, FirstFitPolicy>::value || is_same<Policy, NextFitPolicy>::value) {
+        return MemoryManager::selectHole(sizeInWords, 1); // Bitmap scans, NextFit also moves its cursor
+    }
+    else {
+        return Policy::select(sizeInWords, holeListData());
+    }
+}
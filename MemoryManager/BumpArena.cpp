@@ -0,0 +1,62 @@
+#include "BumpArena.h"
+
+// Constructor - Takes capacityInBytes from memoryManager, which must outlive the arena. If the memory manager
+// has no room, the arena has a capacity of 0 and every allocation fails.
+BumpArena::BumpArena(MemoryManager& memoryManager, size_t capacityInBytes) : memoryManager(memoryManager) {
+    this->start = static_cast<char*>(memoryManager.allocate(capacityInBytes));
+    this->capacity = (start == nullptr) ? 0 : capacityInBytes;
+    this->used = 0;
+}
+
+// Destructor - Returns the whole block to the memory manager.
+BumpArena::~BumpArena() {
+    if (start != nullptr) { memoryManager.free(start); }
+}
+
+// Allocates by bumping the pointer, rounding sizes up to the memory manager's word size. Returns nullptr once
+// the block is used up or if size is 0.
+void* BumpArena::allocate(size_t sizeInBytes) {
+    unsigned wordSize = memoryManager.getWordSize();
+    size_t bytes = (sizeInBytes + wordSize - 1) / wordSize * wordSize; // Keep the next allocation word aligned
+    if (sizeInBytes == 0 || bytes > capacity - used) { return nullptr; }
+
+    void* block = start + used;
+    used += bytes;
+    return block;
+}
+
+// Returns a checkpoint that rewind() can later return to. Checkpoints nest: rewinding to one also discards
+// every checkpoint taken after it.
+size_t BumpArena::mark() {
+    return used;
+}
+
+// Releases everything allocated since checkpoint in O(1).
+void BumpArena::rewind(size_t checkpoint) {
+    if (checkpoint < used) { used = checkpoint; }
+}
+
+// Releases everything allocated from the arena in O(1).
+void BumpArena::reset() {
+    used = 0;
+}
+
+// Returns the bytes handed out so far.
+size_t BumpArena::getUsed() {
+    return used;
+}
+
+// Returns the bytes the arena can hand out in total.
+size_t BumpArena::getCapacity() {
+    return capacity;
+}
+
+// Constructor - Marks the arena's current position.
+ArenaScope::ArenaScope(BumpArena& arena) : arena(arena) {
+    this->checkpoint = arena.mark();
+}
+
+// Destructor - Rewinds the arena to the position marked on construction.
+ArenaScope::~ArenaScope() {
+    arena.rewind(checkpoint);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "MemoryManager.h"
+
+// Linear allocator for request-scoped work, layered on a MemoryManager. One block is taken from the arena up front;
+// allocations just advance a pointer through it and are never freed one at a time. Everything is released at once
+// in O(1) by reset(), or back to a checkpoint by rewind() or an ArenaScope going out of scope.
+class BumpArena {
+    private:
+        MemoryManager& memoryManager;
+        char* start;
+        size_t capacity;
+        size_t used;
+
+    public:
+        // Constructor - Takes capacityInBytes from memoryManager, which must outlive the arena. If the memory manager
+        // has no room, the arena has a capacity of 0 and every allocation fails.
+        BumpArena(MemoryManager& memoryManager, size_t capacityInBytes);
+        // Destructor - Returns the whole block to the memory manager.
+        ~BumpArena();
+
+        BumpArena(const BumpArena&) = delete;
+        BumpArena& operator=(const BumpArena&) = delete;
+
+        // Allocates by bumping the pointer, rounding sizes up to the memory manager's word size. Returns nullptr once
+        // the block is used up or if size is 0.
+        void* allocate(size_t sizeInBytes);
+
+        // Returns a checkpoint that rewind() can later return to. Checkpoints nest: rewinding to one also discards
+        // every checkpoint taken after it.
+        size_t mark();
+
+        // Releases everything allocated since checkpoint in O(1).
+        void rewind(size_t checkpoint);
+
+        // Releases everything allocated from the arena in O(1).
+        void reset();
+
+        // Returns the bytes handed out so far.
+        size_t getUsed();
+
+        // Returns the bytes the arena can hand out in total.
+        size_t getCapacity();
+};
+
+// Checkpoint that rewinds its arena when it goes out of scope, releasing everything allocated during its lifetime.
+// Scopes nest naturally, inner ones rewinding first.
+class ArenaScope {
+    private:
+        BumpArena& arena;
+        size_t checkpoint;
+
+    public:
+        // Constructor - Marks the arena's current position.
+        ArenaScope(BumpArena& arena);
+        // Destructor - Rewinds the arena to the position marked on construction.
+        ~ArenaScope();
+
+        ArenaScope(const ArenaScope&) = delete;
+        ArenaScope& operator=(const ArenaScope&) = delete;
+};
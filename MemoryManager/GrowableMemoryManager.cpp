@@ -0,0 +1,83 @@
+#include "GrowableMemoryManager.h"
+
+// Constructor - Sets native word size (in bytes, for alignment), the allocator function used in every region and the
+// offset width of the regions, which caps their size as in MemoryManager::initialize().
+GrowableMemoryManager::GrowableMemoryManager(unsigned wordSize, function<int(int, void*)> allocator,
+    OffsetWidth offsetWidth) {
+    this->wordSize = wordSize;
+    this->allocator = allocator;
+    this->offsetWidth = offsetWidth;
+    this->regionWords = 0;
+    this->first = nullptr;
+}
+
+// Destructor - Releases every region.
+GrowableMemoryManager::~GrowableMemoryManager() {
+    shutdown();
+}
+
+// Creates the first region, of sizeInWords words; every region added later has the same size unless an allocation
+// needs more. Cleans up previous regions if applicable.
+void GrowableMemoryManager::initialize(size_t sizeInWords) {
+    shutdown();
+    regionWords = sizeInWords;
+    first = addRegion(sizeInWords);
+}
+
+// Releases every region; any block still allocated becomes invalid.
+void GrowableMemoryManager::shutdown() {
+    regions.clear();
+    first = nullptr;
+}
+
+// Allocates from the first region that can fit the block, adding a region if none can. If size is invalid or a new
+// region cannot be created, returns nullptr.
+void* GrowableMemoryManager::allocate(size_t sizeInBytes) {
+    if (sizeInBytes == 0 || first == nullptr) { return nullptr; }
+
+    for (auto& region : regions) {
+        void* block = region.second->allocate(sizeInBytes);
+        if (block != nullptr) { return block; }
+    }
+
+    // Every region is too full or too fragmented, so add one big enough for at least this block
+    MemoryManager* region = addRegion(max(regionWords, (sizeInBytes + wordSize - 1) / wordSize));
+    if (region == nullptr) { return nullptr; }
+    void* block = region->allocate(sizeInBytes);
+    if (block == nullptr) { regions.erase((char*)region->getMemoryStart()); } // Bigger than any region can be
+    return block;
+}
+
+// Frees the block in whichever region it came from, releasing that region if it is now empty. Addresses that were not
+// returned by allocate() are ignored.
+void GrowableMemoryManager::free(void* address) {
+    MemoryManager* region = getRegion(address);
+    if (region == nullptr) { return; }
+
+    region->free(address);
+    if (region != first && region->isEmpty()) { regions.erase((char*)region->getMemoryStart()); }
+}
+
+// Returns the region a block was allocated from, for looking at its hole list or bitmap, or nullptr.
+MemoryManager* GrowableMemoryManager::getRegion(void* address) {
+    // The region starting at or before address is the only one that can contain it
+    auto region = regions.upper_bound((char*)address);
+    if (region == regions.begin()) { return nullptr; }
+    --region;
+    if ((char*)address >= region->first + region->second->getMemoryLimit()) { return nullptr; }
+    return region->second.get();
+}
+
+// Returns the number of regions currently held.
+size_t GrowableMemoryManager::getRegionCount() {
+    return regions.size();
+}
+
+// Adds a region of sizeInWords words, returning nullptr if it cannot be initialized.
+MemoryManager* GrowableMemoryManager::addRegion(size_t sizeInWords) {
+    unique_ptr<MemoryManager> region(new MemoryManager(wordSize, allocator, offsetWidth));
+    region->initialize(sizeInWords);
+    if (region->getMemoryLimit() == 0) { return nullptr; }
+    char* start = (char*)region->getMemoryStart();
+    return (regions[start] = move(region)).get();
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "MemoryManager.h"
+#include <map>
+
+// Memory manager that grows instead of failing. Memory is a list of fixed regions, each a MemoryManager with its own
+// hole list, so growing never moves or invalidates a block that has been handed out. When no region can fit an
+// allocation a new one is added, and a region that becomes completely free again is released, except the first.
+class GrowableMemoryManager {
+    private:
+        unsigned wordSize;
+        function<int(int, void*)> allocator;
+        OffsetWidth offsetWidth;
+        size_t regionWords; // Size of each new region, unless an allocation needs a bigger one
+        map<char*, unique_ptr<MemoryManager>> regions; // By start address, to find the region a freed block is in
+        MemoryManager* first; // Region created by initialize(), kept until shutdown()
+
+        // Adds a region of sizeInWords words, returning nullptr if it cannot be initialized.
+        MemoryManager* addRegion(size_t sizeInWords);
+
+    public:
+        // Constructor - Sets native word size (in bytes, for alignment), the allocator function used in every region
+        // and the offset width of the regions, which caps their size as in MemoryManager::initialize().
+        GrowableMemoryManager(unsigned wordSize, function<int(int, void*)> allocator,
+            OffsetWidth offsetWidth = OffsetWidth::Bits16);
+        // Destructor - Releases every region.
+        ~GrowableMemoryManager();
+
+        GrowableMemoryManager(const GrowableMemoryManager&) = delete;
+        GrowableMemoryManager& operator=(const GrowableMemoryManager&) = delete;
+
+        // Creates the first region, of sizeInWords words; every region added later has the same size unless an
+        // allocation needs more. Cleans up previous regions if applicable.
+        void initialize(size_t sizeInWords);
+
+        // Releases every region; any block still allocated becomes invalid.
+        void shutdown();
+
+        // Allocates from the first region that can fit the block, adding a region if none can. If size is invalid or
+        // a new region cannot be created, returns nullptr.
+        void* allocate(size_t sizeInBytes);
+
+        // Frees the block in whichever region it came from, releasing that region if it is now empty. Addresses that
+        // were not returned by allocate() are ignored.
+        void free(void* address);
+
+        // Returns the region a block was allocated from, for looking at its hole list or bitmap, or nullptr.
+        MemoryManager* getRegion(void* address);
+
+        // Returns the number of regions currently held.
+        size_t getRegionCount();
+};
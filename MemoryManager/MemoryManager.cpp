@@ -1,171 +1,867 @@
 #include "MemoryManager.h"
+#include <atomic>
+#include <unordered_map>
+#include <numeric>
+#include <iterator>
+#include <cerrno>
+#include <pthread.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <chrono>
+#include <cassert>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Blocks freed by one thread into one memory manager, by size class (bins[i] holds blocks of i+1 words).
+struct ThreadCache {
+    vector<void*> bins[MemoryManager::threadCacheClasses];
+    StatCounters counters; // Events of the owning thread, see MemoryManager::statCounters()
+};
+
+// Managers in concurrent mode, so a thread can flush its caches on exit without touching a destroyed manager.
+static mutex& registryLock() {
+    static mutex lock;
+    return lock;
+}
+static unordered_map<uint64_t, MemoryManager*>& registry() {
+    static unordered_map<uint64_t, MemoryManager*> managers;
+    return managers;
+}
+
+// The thread caches a thread has been handed, by manager id. Hands them back when the thread exits.
+struct ThreadCacheHandle {
+    vector<pair<uint64_t, ThreadCache*>> caches;
+
+    ~ThreadCacheHandle() {
+        lock_guard<mutex> lock(registryLock());
+        for (auto& entry : caches) {
+            auto manager = registry().find(entry.first);
+            if (manager == registry().end()) { continue; }
+            lock_guard<mutex> central(manager->second->centralLock);
+            manager->second->retireThreadCache(entry.second);
+        }
+    }
+};
+static thread_local ThreadCacheHandle threadCacheHandle;
+
+// Reads the time-stamp counter, or a nanosecond clock on machines without one.
+static inline uint64_t readTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// One change to the bitmap of a persistent arena, logged for the other memory managers attached to it.
+struct SharedChange {
+    uint32_t offset;
+    uint32_t length;
+    uint32_t used;
+};
+static constexpr unsigned sharedLogLength = 128; // Changes a manager can fall behind by and still catch up by replay
+
+// Start of a persistent arena's file. The partition table follows on the next page, then the arena itself.
+struct SharedHeader {
+    uint64_t magic;
+    uint32_t wordSize;
+    uint32_t engine;
+    uint64_t memSize;
+    uint64_t generation; // Changes made so far, the last sharedLogLength of them kept in changes
+    pthread_mutex_t lock; // Process-shared and robust, so a process dying mid-call does not wedge the rest
+    SharedChange changes[sharedLogLength]; // Change g is at changes[g % sharedLogLength]
+
+    // The Buddy or TLSF engine's free lists, whose tags are in the arena; valid once engineReady is set
+    uint32_t engineReady;
+    uint32_t minBlockWords;
+    uint64_t engineHoles;
+    unsigned freeHeads[32];
+    uint32_t nonEmptyOrders;
+    unsigned tlsfHeads[MemoryManager::tlsfFirstLevels][MemoryManager::tlsfSecondLevels];
+    uint32_t firstLevelMap;
+    uint32_t secondLevelMaps[MemoryManager::tlsfFirstLevels];
+};
+static const uint64_t sharedMagic = 0x324D4D4D454D4D4DULL; // "MMMEMMM2"
+
+// Holds the lock of a persistent arena for one public call, first catching this memory manager up with whatever the
+// others have changed since it last looked, and publishes the engine's free lists afterwards if the call changed them.
+// Does nothing for a private arena.
+class SharedGuard {
+    private:
+        MemoryManager* manager;
+        bool modifies;
+        uint64_t startGeneration;
+
+    public:
+        SharedGuard(MemoryManager* manager, bool modifies) {
+            this->manager = (manager->shared == nullptr) ? nullptr : manager;
+            this->modifies = modifies;
+            if (this->manager == nullptr) { return; }
+
+            SharedHeader* header = manager->shared;
+            if (pthread_mutex_lock(&header->lock) == EOWNERDEAD) { // Owner died mid-call, trust only the table
+                pthread_mutex_consistent(&header->lock);
+                header->engineReady = 0;
+            }
+            if (header->engineReady == 0) { manager->resetShared(); }
+            else if (header->generation != manager->sharedGeneration) { manager->syncShared(); }
+            this->startGeneration = manager->sharedGeneration;
+        }
+
+        ~SharedGuard() {
+            if (manager == nullptr) { return; }
+            if (modifies && manager->sharedGeneration != startGeneration) { manager->publishEngine(); }
+            pthread_mutex_unlock(&manager->shared->lock);
+        }
+};
 
 // Constructor - Sets native word size (in bytes, for alignment) and default allocator for finding a memory hole.
-MemoryManager::MemoryManager(unsigned wordSize, function<int(int, void*)> allocator) {
+MemoryManager::MemoryManager(unsigned wordSize, function<int(int, void*)> allocator)
+    : MemoryManager(wordSize, allocator, OffsetWidth::Bits16) {}
+
+// Constructor - Same as above, with the offset width used for getList(), getBitmap() and the allocator function.
+MemoryManager::MemoryManager(unsigned wordSize, function<int(int, void*)> allocator, OffsetWidth offsetWidth) {
     this->wordSize = wordSize;
-    this->allocator = allocator;
+    this->offsetWidth = offsetWidth;
+    this->policy = FitPolicy::Custom;
+    this->sizeIndexed = false;
+    this->nextFitCursor = 0;
+    this->memSize = 0;
+    this->memory = nullptr;
+    this->memoryBytes = 0;
+    this->mappedBytes = 0;
+    this->partitions = nullptr;
+    this->bitmap = nullptr;
+    this->metadata = nullptr;
+    this->metadataBytes = 0;
+    this->shared = nullptr;
+    this->sharedBytes = 0;
+    this->sharedGeneration = 0;
+    this->wordsInUse = 0;
+    this->peakWordsInUse = 0;
+    this->latencySampling = false;
+    this->lastHole = TraceRecord::noOffset;
+    this->compactCursor = 0;
+    this->deferFrees = false;
+    this->deferredCount = 0;
+    this->concurrent = false;
+    this->engine = Engine::HoleList;
+    this->holesStale = false;
+    this->engineHoles = 0;
+    this->minBlockWords = 1;
+    static atomic<uint64_t> nextId(1);
+    this->id = nextId++;
+    setAllocator(allocator);
+}
+
+// Constructor - Sets native word size and an allocation engine that picks holes itself, such as Buddy.
+MemoryManager::MemoryManager(unsigned wordSize, Engine engine, OffsetWidth offsetWidth)
+    : MemoryManager(wordSize, bestFit, offsetWidth) {
+    this->engine = engine;
+    this->sizeIndexed = false; // Holes are only a report for these engines, there is nothing to index
 }
 // Destructor - Releases all memory allocated by this object without leaking memory.
 MemoryManager::~MemoryManager() {
-    shutdown();
+    setConcurrent(false);
+    release();
 }
 
-// Instantiates block of requested size, no larger than 65536 words; cleans up previous block if applicable.
+// Instantiates block of requested size, no larger than 65535 words (INT_MAX words with Bits32 offsets); cleans
+// up previous block if applicable.
 void MemoryManager::initialize(size_t sizeInWords) {
+    initialize(sizeInWords, ArenaOptions());
+}
+
+// Same as above, with the arena mapped, placed on huge pages or bound to a NUMA node as options ask. Falls back to a
+// heap arena if it cannot be mapped.
+void MemoryManager::initialize(size_t sizeInWords, const ArenaOptions& options) {
+    unique_lock<mutex> lock = lockCentral();
+
     // Clean up previous block
-    shutdown(); 
+    release();
 
     // Set memory to appropriate size
-    memSize = (sizeInWords > 65535) ? 65535 : sizeInWords;
-    memory.resize(memSize*wordSize);
+    size_t maxWords = (offsetWidth == OffsetWidth::Bits32) ? INT_MAX : 65535;
+    memSize = (sizeInWords > maxWords) ? maxWords : sizeInWords;
+    memoryBytes = memSize*wordSize;
+    bool mapped = options.mapped || options.hugePages != HugePages::None || options.numaNode >= 0;
+    if (!mapped || !mapArena(options)) {
+        memory = static_cast<char*>(::operator new(memoryBytes, align_val_t(arenaAlignment)));
+        memset(memory, 0, memoryBytes);
+    }
     holes.push_back(make_pair(0, memSize));
+    // Partition table and bitmap, padded to whole 64-bit words (extra 0s for bitmap return simplification). A mapped
+    // arena maps them too, the rest come from the heap
+    if (mappedBytes == 0 || !mapMetadata()) {
+        partitionStore.assign(memSize, 0);
+        bitmapStore.assign((memSize + 63) / 64, 0);
+        partitions = partitionStore.data();
+        bitmap = bitmapStore.data();
+    }
+    nextFitCursor = 0;
+    syncHoleList();
+    syncHoleIndex();
+
+    initializeEngine();
+}
+
+// Attaches to the persistent arena in the file at path (a path under /dev/shm gives a shared memory object), creating
+// it with sizeInWords words if the file does not exist; an existing arena keeps its own size and every block allocated
+// in it. The arena and its partition table live in the file mapping, so any number of memory managers, in this or
+// other processes, can attach to it at once and a restarted process picks up where it left off. Calls are serialized
+// across processes by a lock in the file, which also logs the last sharedLogLength changes; a manager replays the ones
+// others made since its last call, and only rebuilds its holes and bitmap from the partition table (O(words)) if it
+// has fallen further behind than that. Concurrent and deferred free modes are not available on a persistent arena.
+// shutdown() detaches and leaves the file in place. Returns false if either mode is on, the file cannot be mapped or it
+// holds an arena of another word size or engine.
+bool MemoryManager::attach(const char* path, size_t sizeInWords) {
+    if (concurrent || deferFrees) { return false; } // Neither mode's blocks would be visible to other processes
+    release();
+
+    int fd = open(path, O_CREAT | O_RDWR, S_IRUSR | S_IWUSR);
+    if (fd == -1) { return false; }
+    flock(fd, LOCK_EX); // Only one process gets to create the arena, the rest wait and attach to it
+    struct stat info;
+    bool created = fstat(fd, &info) == 0 && info.st_size == 0;
+
+    // Size the layout from the file's own header if it already holds an arena
+    size_t maxWords = (offsetWidth == OffsetWidth::Bits32) ? INT_MAX : 65535;
+    size_t words = (sizeInWords > maxWords) ? maxWords : sizeInWords;
+    SharedHeader existing;
+    if (!created) {
+        bool valid = pread(fd, &existing, sizeof(existing), 0) == sizeof(existing) && existing.magic == sharedMagic
+            && existing.wordSize == wordSize && existing.engine == (uint32_t)engine && existing.memSize <= maxWords;
+        if (!valid) { close(fd); return false; }
+        words = existing.memSize;
+    }
+    size_t tableBytes = (words*sizeof(unsigned) + arenaAlignment - 1) / arenaAlignment * arenaAlignment;
+    size_t bytes = arenaAlignment + tableBytes + words*wordSize;
+    static_assert(sizeof(SharedHeader) <= arenaAlignment, "The header has the first page to itself");
+    if (words == 0 || (created && ftruncate(fd, bytes) == -1) || (!created && (size_t)info.st_size < bytes)) {
+        close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) { close(fd); return false; }
+    SharedHeader* header = static_cast<SharedHeader*>(mapping);
+    if (created) { // ftruncate zero-filled the file, so every partition is already empty and the engine not ready
+        header->wordSize = wordSize;
+        header->engine = (uint32_t)engine;
+        header->memSize = words;
+        header->generation = 1;
+        pthread_mutexattr_t attributes;
+        pthread_mutexattr_init(&attributes);
+        pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+        pthread_mutex_init(&header->lock, &attributes);
+        pthread_mutexattr_destroy(&attributes);
+        header->magic = sharedMagic;
+    }
+    flock(fd, LOCK_UN); // The mapping keeps the file open, so closing alone would not drop the lock
+    close(fd);
+
+    shared = header;
+    sharedBytes = bytes;
+    sharedGeneration = 0; // Forces a rebuild on the first call, however few changes have been logged
+    memSize = words;
+    memoryBytes = words*wordSize;
+    partitions = reinterpret_cast<unsigned*>(static_cast<char*>(mapping) + arenaAlignment);
+    memory = static_cast<char*>(mapping) + arenaAlignment + tableBytes;
+    bitmapStore.assign((memSize + 63) / 64, 0);
+    bitmap = bitmapStore.data();
+    nextFitCursor = 0;
+    SharedGuard guard(this, false);
+    return true;
+}
+
+// Rebuilds holes, bitmap and words in use from the partition table in O(words). The engine's free lists are in the
+// file and left alone.
+void MemoryManager::rebuildFromPartitions() {
+    holes.clear();
+    fill(bitmap, bitmap + (memSize + 63) / 64, 0);
+    wordsInUse = 0;
+    for (unsigned offset = 0; offset < memSize;) {
+        if (partitions[offset] != 0) {
+            markBitmapWords(bitmap, offset, partitions[offset], true); // Private, nothing to log
+            useWords(partitions[offset]);
+            offset += partitions[offset];
+            continue;
+        }
+        unsigned end = offset + 1;
+        while (end < memSize && partitions[end] == 0) { end++; }
+        holes.push_back(make_pair(offset, end - offset));
+        offset = end;
+    }
+    syncHoleList();
+    syncHoleIndex();
+    holesStale = false;
+}
+
+// Rebuilds everything of a persistent arena from its partition table, on first use or after a process died mid-call:
+// holes and bitmap, then the engine's free lists and tags, which are published. The generation jumps past the log so
+// every other attached manager rebuilds too.
+void MemoryManager::resetShared() {
+    rebuildFromPartitions();
+    initializeEngine();
+    publishEngine();
+    shared->generation += sharedLogLength + 1;
+    sharedGeneration = shared->generation;
+    shared->engineReady = 1;
+}
+
+// Catches holes, bitmap and the engine's free lists up with the changes other managers have made to a persistent
+// arena since this one's last call, replaying each logged change as its maker did. Rebuilds from the partition table
+// instead if more changes have been made than the log holds.
+void MemoryManager::syncShared() {
+    if (sharedGeneration == 0 || shared->generation - sharedGeneration > sharedLogLength) { rebuildFromPartitions(); }
+    else {
+        for (uint64_t generation = sharedGeneration; generation != shared->generation; generation++) {
+            SharedChange& change = shared->changes[generation % sharedLogLength];
+            applyChange(change.offset, change.length, change.used != 0);
+        }
+    }
+    sharedGeneration = shared->generation;
+    loadEngine();
+}
+
+// Applies one logged change of another manager to holes, bitmap and words in use. Engines other than HoleList only
+// mark holes stale, as they would for a change of their own.
+void MemoryManager::applyChange(unsigned offset, unsigned length, bool used) {
+    markBitmapWords(bitmap, offset, length, used);
+    if (used) { useWords(length); }
+    else { wordsInUse -= length; }
+    if (engine != Engine::HoleList) { holesStale = true; }
+    else if (used) { removeHoleWords(offset, length); }
+    else { addHoleWords(offset, length); }
+}
+
+// Copies the engine's free lists from a persistent arena's header, where the manager that last changed them left them.
+void MemoryManager::loadEngine() {
+    if (engine == Engine::HoleList) { return; }
+    minBlockWords = shared->minBlockWords;
+    engineHoles = shared->engineHoles;
+    memcpy(freeHeads, shared->freeHeads, sizeof(freeHeads));
+    nonEmptyOrders = shared->nonEmptyOrders;
+    memcpy(tlsfHeads, shared->tlsfHeads, sizeof(tlsfHeads));
+    firstLevelMap = shared->firstLevelMap;
+    memcpy(secondLevelMaps, shared->secondLevelMaps, sizeof(secondLevelMaps));
+}
 
-    // Bitmap initialization
-    int bitmapSize = 0;
-    if (memSize % 8 == 0) { bitmapSize = memSize; }
-    else { bitmapSize = memSize + 8 - (memSize % 8); } // Add extra 0s for bitmap return simplification
-    bitmap.resize(bitmapSize);
+// Copies the engine's free lists to a persistent arena's header, for the next manager to change the arena.
+void MemoryManager::publishEngine() {
+    if (engine == Engine::HoleList) { return; }
+    shared->minBlockWords = minBlockWords;
+    shared->engineHoles = engineHoles;
+    memcpy(shared->freeHeads, freeHeads, sizeof(freeHeads));
+    shared->nonEmptyOrders = nonEmptyOrders;
+    memcpy(shared->tlsfHeads, tlsfHeads, sizeof(tlsfHeads));
+    shared->firstLevelMap = firstLevelMap;
+    memcpy(shared->secondLevelMaps, secondLevelMaps, sizeof(secondLevelMaps));
 }
 
 // Releases memory block acquired during initialization, if any. This should only include memory created for
 // long term use not those that returned such as getList() or getBitmap() as whatever is calling those should
 // delete it instead.
 void MemoryManager::shutdown() {
-    memory.clear();
+    unique_lock<mutex> lock = lockCentral();
+    release();
+}
+
+// Unlocked body of shutdown(). Cached blocks point into the old block, so thread caches are emptied too.
+void MemoryManager::release() {
+    for (auto& cache : threadCaches) {
+        for (auto& bin : cache->bins) { bin.clear(); }
+        cache->counters.reset();
+    }
+    counters.reset();
+    wordsInUse = 0;
+    peakWordsInUse = 0;
+    if (shared != nullptr) { munmap(shared, sharedBytes); }
+    else if (mappedBytes != 0) { munmap(memory, mappedBytes); }
+    else if (memory != nullptr) { ::operator delete(memory, align_val_t(arenaAlignment)); }
+    memory = nullptr;
+    memoryBytes = 0;
+    mappedBytes = 0;
+    shared = nullptr;
+    sharedBytes = 0;
     holes.clear();
-    partitions.clear();
-    bitmap.clear();
+    if (metadata != nullptr) { munmap(metadata, metadataBytes); }
+    metadata = nullptr;
+    metadataBytes = 0;
+    partitionStore.clear();
+    partitions = nullptr;
+    bitmapStore.clear();
+    bitmap = nullptr;
+    holeList.clear();
+    wideHoleList.clear();
+    dumpSnapshot.clear();
+    holesBySize.clear();
+    holesStale = false;
+    engineHoles = 0;
+    minBlockWords = 1;
+    handles.clear();
+    freeHandles.clear();
+    relocatable.clear();
+    compactCursor = 0;
+    quickLists.clear();
+    deferredCount = 0;
+}
+
+// Maps memoryBytes of arena as options ask, returning false if no mapping could be made.
+bool MemoryManager::mapArena(const ArenaOptions& options) {
+    if (memoryBytes == 0) { return false; }
+    const size_t hugePageBytes = 2 << 20;
+    void* arena = MAP_FAILED;
+
+    if (options.hugePages == HugePages::Explicit) {
+        mappedBytes = (memoryBytes + hugePageBytes - 1) / hugePageBytes * hugePageBytes;
+        arena = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+    if (arena == MAP_FAILED) {
+        mappedBytes = (memoryBytes + arenaAlignment - 1) / arenaAlignment * arenaAlignment;
+        bool transparent = options.hugePages != HugePages::None;
+        // Transparent huge pages only back 2MB-aligned ranges, so over-map and trim the mapping to a boundary
+        size_t slack = (transparent && mappedBytes >= hugePageBytes) ? hugePageBytes : 0;
+        char* start = static_cast<char*>(mmap(nullptr, mappedBytes + slack, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (start == MAP_FAILED) { mappedBytes = 0; return false; }
+        if (slack != 0) {
+            size_t front = (hugePageBytes - (uintptr_t)start % hugePageBytes) % hugePageBytes;
+            if (front != 0) { munmap(start, front); }
+            if (slack - front != 0) { munmap(start + front + mappedBytes, slack - front); }
+            start += front;
+        }
+        if (transparent) { madvise(start, mappedBytes, MADV_HUGEPAGE); }
+        arena = start;
+    }
+
+    // Bind before anything touches the arena, so every page is first faulted in on the chosen node
+    if (options.numaNode >= 0) {
+        const int mpolBind = 2; // MPOL_BIND from <numaif.h>, which needs libnuma headers
+        const size_t maskBits = 8 * sizeof(unsigned long);
+        vector<unsigned long> nodeMask(options.numaNode / maskBits + 1);
+        nodeMask[options.numaNode / maskBits] |= 1ul << (options.numaNode % maskBits);
+        syscall(SYS_mbind, arena, mappedBytes, mpolBind, nodeMask.data(), nodeMask.size() * maskBits + 1, 0);
+    }
+
+    memory = static_cast<char*>(arena);
+    return true;
+}
+
+// Maps the partition table and bitmap of a mapped arena in one anonymous mapping, zeroed lazily like the arena, so
+// neither is allocated and cleared word by word up front. Returns false if no mapping could be made.
+bool MemoryManager::mapMetadata() {
+    size_t tableBytes = (memSize*sizeof(unsigned) + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+    size_t bytes = tableBytes + (memSize + 63) / 64 * sizeof(uint64_t);
+    void* mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) { return false; }
+    metadata = static_cast<char*>(mapping);
+    metadataBytes = bytes;
+    partitions = reinterpret_cast<unsigned*>(metadata);
+    bitmap = reinterpret_cast<uint64_t*>(metadata + tableBytes);
+    return true;
 }
 
 // Allocates a memory partition using the allocator function. If no memory is available or size is invalid, returns nullptr.
 void* MemoryManager::allocate(size_t sizeInBytes) {
+    SharedGuard guard(this, true);
+
     // Check for invalid allocation
-    if (sizeInBytes > memSize*wordSize || sizeInBytes < 0 || memory.size() == 0) { return nullptr; }
+    if (sizeInBytes > memSize*wordSize || sizeInBytes == 0 || memoryBytes == 0) { return nullptr; }
 
-    unsigned words = ceil(sizeInBytes/wordSize);
+    unsigned words = (sizeInBytes + wordSize - 1) / wordSize; // Round up to whole words
 
-    // Get holes array and find allocation offset
-    uint16_t* list = (uint16_t*)getList();
-    int holeSelected = allocator(words, list);
-    delete [] list; 
-    if (holeSelected == -1) { return nullptr; } // No hole can fit allocation
+    bool sampling = latencySampling.load(memory_order_relaxed);
+    uint64_t startTicks = sampling ? readTicks() : 0;
+    void* block = concurrent ? cachedAllocate(words) : allocateWords(words, 1);
+    if (tracer) { traceEvent(TraceEvent::Allocate, sizeInBytes, block, concurrent ? TraceRecord::noOffset : lastHole); }
+    StatCounters& target = statCounters();
+    countAllocations(target, sizeInBytes, block != nullptr, block == nullptr);
+    if (sampling) { countLatency(target.allocateTicks, startTicks); }
+    return block;
+}
 
-    // Find index of hole in holes container
-    unsigned index = 0;
-    for (unsigned i = 0; i < holes.size(); i++) {
-        if (holes[i].first == holeSelected) {
-            index = i;
-            break;
+// Allocates like allocate(), but the returned address is a multiple of alignment (in bytes, a power of two),
+// e.g. 64 for cache-line or AVX-512 buffers. Padding skipped in front of the block stays a hole. Returns
+// nullptr if no hole can fit the block once aligned. The Buddy engine supports alignments up to
+// arenaAlignment; bigger ones fail.
+void* MemoryManager::allocateAligned(size_t sizeInBytes, size_t alignment) {
+    // Check for invalid allocation
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) { return nullptr; } // Not a power of two
+    if (sizeInBytes > memSize*wordSize || sizeInBytes == 0 || memoryBytes == 0) { return nullptr; }
+
+    unsigned words = (sizeInBytes + wordSize - 1) / wordSize; // Round up to whole words
+
+    // Thread caches do not track alignment, so aligned blocks always come from the holes
+    unique_lock<mutex> lock = lockCentral();
+    SharedGuard guard(this, true);
+    bool sampling = latencySampling.load(memory_order_relaxed);
+    uint64_t startTicks = sampling ? readTicks() : 0;
+    void* block = allocateWords(words, alignment);
+    if (tracer) { traceEvent(TraceEvent::Allocate, sizeInBytes, block, lastHole); }
+    countAllocations(counters, sizeInBytes, block != nullptr, block == nullptr);
+    if (sampling) { countLatency(counters.allocateTicks, startTicks); }
+    return block;
+}
+
+// Unlocked body of allocate() and allocateAligned(), once the request has been validated and rounded to words. An
+// alignment of 1 means any word will do.
+void* MemoryManager::allocateWords(unsigned sizeInWords, size_t alignment) {
+    if (engine == Engine::Buddy) { return buddyAllocate(sizeInWords, alignment); }
+    if (engine == Engine::TLSF) { return tlsfAllocate(sizeInWords, alignment); }
+
+    // A deferred free of the same length is still a live partition, so it can be handed straight back
+    if (deferredCount != 0 && alignment == 1) {
+        auto queued = quickLists.find(sizeInWords);
+        if (queued != quickLists.end() && !queued->second.empty()) {
+            unsigned wordOffset = queued->second.back();
+            queued->second.pop_back();
+            deferredCount--;
+            lastHole = wordOffset;
+            return &memory[(size_t)wordOffset*wordSize];
         }
     }
 
-    // If allocation fits perfectly in hole just erase the hole
-    if (holes[index].second == words) { 
-        holes.erase(holes.begin() + index);
+    int holeSelected = selectHole(sizeInWords, alignment);
+    if (holeSelected == -1 && deferredCount != 0) { // Merge the deferred frees and look again
+        flushDeferred();
+        holeSelected = selectHole(sizeInWords, alignment);
     }
-    else { // Otherwise create a smaller hole with new word offset
-        holes[index].first = holeSelected + words;
-        holes[index].second = holes[index].second - words;
+    if (holeSelected == -1) { return nullptr; } // No hole can fit allocation
+    if (!claim(holeSelected, sizeInWords)) { return nullptr; } // Allocator picked words that are not free
+
+    return &memory[(size_t)holeSelected*wordSize];
+}
+
+// Frees the memory partition within the memory manager so that it can be reused. Addresses that were not returned
+// by allocate() are ignored.
+void MemoryManager::free(void* address) {
+    SharedGuard guard(this, true);
+
+    // Find word offset in memory of the address we are freeing
+    if (memoryBytes == 0 || address < &memory[0]) { return; }
+    size_t byteOffset = (char*)address - &memory[0];
+    if (byteOffset >= memoryBytes || byteOffset % wordSize != 0) { return; }
+    unsigned wordOffset = byteOffset / wordSize;
+    if (partitions[wordOffset] == 0) { return; } // Not the start of a live partition
+
+    freeBlock(address, wordOffset, partitions[wordOffset]);
+}
+
+// Sized free: like free(), but trusts sizeInBytes to be the size address was allocated with, e.g. when a container or
+// std::pmr caller knows it. None of the address checks run and the block's length is taken from sizeInBytes instead of
+// the partition table, except on the Buddy and TLSF engines, which round blocks up when they hand them out. Only a
+// debug build (NDEBUG not defined) asserts that address starts a live block of that size; anything else is undefined
+// behaviour in a release build.
+void MemoryManager::free(void* address, size_t sizeInBytes) {
+    SharedGuard guard(this, true);
+
+    size_t byteOffset = (char*)address - &memory[0];
+    unsigned wordOffset = byteOffset / wordSize;
+    unsigned length = (sizeInBytes + wordSize - 1) / wordSize;
+    if (engine != Engine::HoleList) { length = partitions[wordOffset]; } // Rounded up to a whole block on allocation
+
+#ifndef NDEBUG
+    assert(memoryBytes != 0 && address >= &memory[0] && byteOffset < memoryBytes && byteOffset % wordSize == 0);
+    assert(sizeInBytes != 0 && length != 0 && length >= (sizeInBytes + wordSize - 1) / wordSize);
+    assert(partitions[wordOffset] == length);
+#endif
+
+    freeBlock(address, wordOffset, length);
+}
+
+// Frees the live partition of length words at wordOffset, once free() has found or been told its length.
+void MemoryManager::freeBlock(void* address, unsigned wordOffset, unsigned length) {
+    bool sampling = latencySampling.load(memory_order_relaxed);
+    uint64_t startTicks = sampling ? readTicks() : 0;
+    if (tracer) { traceEvent(TraceEvent::Free, (uint64_t)length*wordSize, address, TraceRecord::noOffset); }
+    if (concurrent) { cachedFree(wordOffset, length); }
+    else { freeWords(wordOffset, length); }
+    StatCounters& target = statCounters();
+    StatCounters::add(target.frees, 1);
+    if (sampling) { countLatency(target.freeTicks, startTicks); }
+}
+
+// Resizes the block at address to sizeInBytes and returns its new address, keeping the contents up to the smaller of
+// the two sizes. Shrinking splits the tail off as a hole and growing extends into the hole right after the block, so
+// the block only moves (allocate, copy, free) when that hole is too small. A nullptr address allocates and a size of
+// 0 frees; on failure returns nullptr and the old block is left untouched.
+void* MemoryManager::reallocate(void* address, size_t sizeInBytes) {
+    if (address == nullptr) { return allocate(sizeInBytes); }
+    if (sizeInBytes == 0) { free(address); return nullptr; }
+    if (memoryBytes == 0 || sizeInBytes > memSize*wordSize || address < &memory[0]) { return nullptr; }
+    size_t byteOffset = (char*)address - &memory[0];
+    if (byteOffset >= memoryBytes || byteOffset % wordSize != 0) { return nullptr; }
+    unsigned wordOffset = byteOffset / wordSize;
+
+    unsigned words = (sizeInBytes + wordSize - 1) / wordSize; // Round up to whole words
+
+    // The block may be handed to a thread cache by its next free(), which reads its length from partitions, so the
+    // whole resize runs under the central lock
+    unique_lock<mutex> lock = lockCentral();
+    SharedGuard guard(this, true);
+    unsigned length = partitions[wordOffset];
+    if (length == 0) { return nullptr; } // Not the start of a live partition
+    if (resizeWords(wordOffset, words)) {
+        if (tracer) {
+            traceEvent(TraceEvent::Free, (uint64_t)length*wordSize, address, TraceRecord::noOffset);
+            traceEvent(TraceEvent::Allocate, sizeInBytes, address, wordOffset);
+        }
+        return address;
     }
 
-    // Keep track of memory partitions
-    partitions.push_back(make_pair(holeSelected, words));
-    sort(partitions.begin(), partitions.end());
+    // Last resort: move the block
+    void* moved = allocateWords(words, 1);
+    countAllocations(counters, sizeInBytes, moved != nullptr, moved == nullptr);
+    if (tracer && moved != nullptr) {
+        traceEvent(TraceEvent::Free, (uint64_t)length*wordSize, address, TraceRecord::noOffset);
+        traceEvent(TraceEvent::Allocate, sizeInBytes, moved, lastHole);
+    }
+    if (moved == nullptr) { return nullptr; }
+    memcpy(moved, address, (size_t)min(length, words)*wordSize);
+    freeWords(wordOffset, length);
+    StatCounters::add(counters.frees, 1);
+    return moved;
+}
 
-    // Fill bitmap with ones where words were allocated
-    auto start = bitmap.begin() + holeSelected;
-    fill(start, start + words, 1);
+// Allocates up to count blocks of sizeInBytes each into out and returns how many it got. A burst is carved from as
+// few holes as possible, one allocator call and one hole update per hole, instead of count separate allocate() calls.
+// Blocks always come from the holes, even in concurrent mode.
+size_t MemoryManager::allocateMany(size_t count, size_t sizeInBytes, void** out) {
+    // Check for invalid allocation
+    if (sizeInBytes > memSize*wordSize || sizeInBytes == 0 || memoryBytes == 0) { return 0; }
 
-    return &memory[holeSelected*wordSize];
+    unsigned words = (sizeInBytes + wordSize - 1) / wordSize; // Round up to whole words
+    unique_lock<mutex> lock = lockCentral();
+    SharedGuard guard(this, true);
+    size_t allocated = carveWords(count, words, out, sizeInBytes);
+    countAllocations(counters, sizeInBytes, allocated, allocated < count);
+    return allocated;
 }
 
-// Frees the memory partition within the memory manager so that it can be reused.
-void MemoryManager::free(void* address) {
-    // Find word offset in memory of the address we are freeing
-    unsigned wordOffset = 0;
-    for (unsigned i = 0; i < memory.size(); i += wordSize) {
-        if (&memory[i] == address) {
-            wordOffset = i/wordSize;
+// Unlocked body of allocateMany(), also used to refill a thread cache: carves up to count blocks of sizeInWords words
+// into out from as few holes as possible and returns how many it got. Blocks are traced as traceBytes each, or not at
+// all if it is 0, as a refill's blocks are traced when the cache hands them out.
+size_t MemoryManager::carveWords(size_t count, unsigned words, void** out, size_t traceBytes) {
+    size_t allocated = 0;
+    if (engine != Engine::HoleList) { // The engine picks its own blocks, so take them one at a time
+        while (allocated < count) {
+            void* block = allocateWords(words, 1);
+            if (block == nullptr) { break; }
+            if (tracer && traceBytes != 0) { traceEvent(TraceEvent::Allocate, traceBytes, block, lastHole); }
+            out[allocated++] = block;
         }
+        return allocated;
     }
-    
-    // Remove partition from partitions container
-    unsigned length = 0;
-    for (unsigned i = 0; i < partitions.size(); i++) {
-        if (partitions[i].first == wordOffset) {
-            length = partitions[i].second;
-            partitions.erase(partitions.begin() + i);
-            break;
+
+    while (allocated < count) {
+        // Ask for a hole that fits the rest of the burst, settling for one that fits a single block
+        unsigned wanted = min(count - allocated, (size_t)(memSize / words));
+        int offset = selectHole(wanted * words, 1);
+        if (offset == -1 && wanted > 1) { offset = selectHole(words, 1); }
+        if (offset == -1 && deferredCount != 0) { // Merge the deferred frees and look again
+            flushDeferred();
+            continue;
+        }
+        if (offset == -1) { break; } // No hole can fit another block
+
+        // Take as many blocks as the chosen hole has room for after offset
+        auto hole = upper_bound(holes.begin(), holes.end(), make_pair((unsigned)offset, UINT_MAX));
+        if (hole == holes.begin()) { break; }
+        --hole;
+        unsigned end = hole->first + hole->second;
+        if ((unsigned)offset + words > end) { break; } // Allocator picked words that are not free
+        unsigned blocks = min(wanted, (end - offset) / words);
+        claim(offset, blocks * words);
+        if (policy == FitPolicy::NextFit) { nextFitCursor = (offset + blocks*words) % memSize; }
+
+        // Split the claimed run into one partition per block
+        for (unsigned block = 0; block < blocks; block++) {
+            partitions[offset + block*words] = words;
+            void* carved = &memory[(size_t)(offset + block*words)*wordSize];
+            if (tracer && traceBytes != 0) { traceEvent(TraceEvent::Allocate, traceBytes, carved, lastHole); }
+            out[allocated++] = carved;
         }
     }
+    return allocated;
+}
 
-    // Create new hole for freed memory
-    pair<int, int> combine = make_pair(wordOffset, length); 
+// Frees count blocks at once. The freed partitions are sorted and merged into holes in a single pass, so a batch costs
+// one hole list rebuild instead of one per block. Invalid addresses are ignored as by free().
+void MemoryManager::freeMany(void** addresses, size_t count) {
+    if (memoryBytes == 0) { return; }
+    unique_lock<mutex> lock = lockCentral();
+    SharedGuard guard(this, true);
 
-    // Combine holes if possible
-    int erase[2] = {-1, -1};
-    for (unsigned i = 0; i < holes.size(); i++) {
-        // If there is a hole that ends right before the freed memory, combine the holes
-        if (holes[i].first + holes[i].second == wordOffset) {
-            combine = make_pair(holes[i].first, holes[i].second + length);
-            erase[0] = i;
+    // Resolve addresses to partitions, dropping any that are not live (including repeats within the batch)
+    vector<pair<unsigned, unsigned>> freed;
+    freed.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        if (addresses[i] < &memory[0]) { continue; }
+        size_t byteOffset = (char*)addresses[i] - &memory[0];
+        if (byteOffset >= memoryBytes || byteOffset % wordSize != 0) { continue; }
+        unsigned wordOffset = byteOffset / wordSize;
+        if (partitions[wordOffset] == 0) { continue; }
+        StatCounters::add(counters.frees, 1);
+        if (tracer) {
+            uint64_t size = (uint64_t)partitions[wordOffset]*wordSize;
+            traceEvent(TraceEvent::Free, size, addresses[i], TraceRecord::noOffset);
         }
-        // If there is a hole is right after the freed memory, combine the holes
-        if (holes[i].first == combine.first + combine.second) {
-            combine = make_pair(combine.first, combine.second + holes[i].second);
-            erase[1] = i;
-            break;
+
+        if (engine != Engine::HoleList) { // Engines merge blocks as they are freed
+            freeWords(wordOffset, partitions[wordOffset]);
+            continue;
+        }
+        freed.push_back(make_pair(wordOffset, partitions[wordOffset]));
+        markWords(wordOffset, partitions[wordOffset], false);
+        wordsInUse -= partitions[wordOffset];
+        partitions[wordOffset] = 0;
+    }
+    mergeRuns(freed);
+}
+
+// Merges runs, already cleared from partitions and bitmap, into holes in a single sort-merge pass.
+void MemoryManager::mergeRuns(vector<pair<unsigned, unsigned>>& runs) {
+    if (runs.empty()) { return; }
+    sort(runs.begin(), runs.end());
+
+    // Merge the freed runs with the existing holes in offset order, coalescing anything that touches
+    vector<pair<unsigned, unsigned>> merged;
+    merged.reserve(holes.size() + runs.size());
+    auto hole = holes.begin(), run = runs.begin();
+    while (hole != holes.end() || run != runs.end()) {
+        bool takeHole = run == runs.end() || (hole != holes.end() && hole->first < run->first);
+        pair<unsigned, unsigned> next = takeHole ? *hole++ : *run++;
+        if (!merged.empty() && merged.back().first + merged.back().second == next.first) {
+            merged.back().second += next.second;
         }
+        else { merged.push_back(next); }
     }
-    
-    // Erase pairs that have been combined
-    if (erase[0] != -1) { holes.erase(holes.begin() + erase[0]); }
-    if (erase[1] != -1) { holes.erase(holes.begin() + erase[1]); }
+    holes.swap(merged);
+    syncHoleList();
+    syncHoleIndex();
+}
+
+// Resizes the partition at wordOffset without moving it, or returns false and leaves it alone.
+bool MemoryManager::resizeWords(unsigned wordOffset, unsigned sizeInWords) {
+    if (engine == Engine::Buddy) { return buddyResize(wordOffset, sizeInWords); }
+    if (engine == Engine::TLSF) { return tlsfResize(wordOffset, sizeInWords); }
+
+    unsigned length = partitions[wordOffset];
+    if (sizeInWords == length) { return true; }
+    if (sizeInWords < length) { // Turn the tail into a partition of its own and free it, so it merges like any free
+        partitions[wordOffset] = sizeInWords;
+        partitions[wordOffset + sizeInWords] = length - sizeInWords;
+        freeWords(wordOffset + sizeInWords, length - sizeInWords);
+        return true;
+    }
+
+    // Claim the extra words from the hole starting right after the block, then fold them into the partition
+    if (!claim(wordOffset + length, sizeInWords - length)) { return false; }
+    partitions[wordOffset + length] = 0;
+    partitions[wordOffset] = sizeInWords;
+    return true;
+}
+
+// Unlocked body of free(), once the address has been resolved to the offset and length of a live partition.
+void MemoryManager::freeWords(unsigned wordOffset, unsigned length) {
+    if (engine == Engine::Buddy) { return buddyFree(wordOffset, length); }
+    if (engine == Engine::TLSF) { return tlsfFree(wordOffset, length); }
+    if (deferFrees) { return deferWords(wordOffset, length); }
 
-    // Add new hole to holes container and sort
-    holes.push_back(combine);
-    sort(holes.begin(), holes.end());
+    // Remove partition from partitions table
+    partitions[wordOffset] = 0;
+    wordsInUse -= length;
+    addHoleWords(wordOffset, length);
 
     // Fill bitmap with zeros where words were freed
-    auto start = bitmap.begin() + wordOffset;
-    fill(start, start + length, 0);
+    markWords(wordOffset, length, false);
 }
 
 // Changes the allocation algorithm to identifying the memory hole to use for allocation.
+// bestFit and worstFit are recognized and answered from a size-ordered hole index in O(log n) rather than a scan of
+// the hole list; firstFit and nextFit are answered by scanning the bitmap 64 words at a time.
 void MemoryManager::setAllocator(std::function<int(int, void*)> allocator) {
+    unique_lock<mutex> lock = lockCentral();
     this->allocator = allocator;
+
+    auto function = this->allocator.target<int(*)(int, void*)>();
+    if (function && *function == bestFit) { policy = FitPolicy::BestFit; }
+    else if (function && *function == worstFit) { policy = FitPolicy::WorstFit; }
+    else if (function && *function == firstFit) { policy = FitPolicy::FirstFit; }
+    else if (function && *function == nextFit) { policy = FitPolicy::NextFit; }
+    else { policy = FitPolicy::Custom; }
+
+    if (tracer) { traceEvent(TraceEvent::SetAllocator, (uint64_t)policy, nullptr, TraceRecord::noOffset); }
+
+    // Build the index when switching onto a size-based policy, drop it when switching away
+    bool indexed = engine == Engine::HoleList && (policy == FitPolicy::BestFit || policy == FitPolicy::WorstFit);
+    if (indexed != sizeIndexed) {
+        sizeIndexed = indexed;
+        syncHoleIndex();
+    }
 }
 
 // Uses standard POSIX calls to write hole list to filename as text, returning -1 on error and 0 if successful.
 // Format: "[START, LENGTH] - [START, LENGTH] …", e.g., "[0, 10] - [12, 2] - [20, 6]".
 int MemoryManager::dumpMemoryMap(char* filename) {
-    if (memory.size() == 0) { return -1; }
+    return dumpMemoryMap(filename, DumpFormat::Text);
+}
 
-    // Open/create a new file
-    int fd = open(filename, O_CREAT | O_RDWR, S_IRWXU);
-    if (fd == -1) { return -1; }
+// Appends holes in the Binary dump layout: a uint32_t count, then (offset, length) uint32_t pairs, little-endian.
+static void appendBinaryHoles(string& out, const vector<pair<unsigned, unsigned>>& holes) {
+    auto append = [&](uint32_t value) {
+        for (unsigned i = 0; i < 4; i++) { out += (char)(value >> (i*8)); }
+    };
+    append(holes.size());
+    for (auto& hole : holes) {
+        append(hole.first);
+        append(hole.second);
+    }
+}
+
+// Same as above in the given format. The dump is built in memory and written with a single write(), replacing the
+// file, except that Incremental dumps are appended to it.
+int MemoryManager::dumpMemoryMap(char* filename, DumpFormat format) {
+    unique_lock<mutex> lock = lockCentral();
+    if (memoryBytes == 0) { return -1; }
+    SharedGuard guard(this, false);
+    refreshHoles();
 
     string out;
-    char buf[128];
-    if (holes.size() == 0) {
-        out = "[0, 0]";
-        strcpy(buf, out.c_str());
-        write(fd, buf, strlen(buf));
-        close(fd);
-        return 0;
+    if (format == DumpFormat::Text) {
+        out.reserve(holes.size() * 16);
+        for (unsigned i = 0; i < holes.size(); i++) {
+            if (i != 0) { out += " - "; }
+            out += "[" + to_string(holes[i].first) + ", " + to_string(holes[i].second) + "]";
+        }
+        if (holes.size() == 0) { out = "[0, 0]"; }
     }
-
-    // Write holes list to output file with specified format
-    for (int i = 0; i < holes.size()-1; i++) {
-        out = "[" + to_string(holes[i].first) + ", " + to_string(holes[i].second) + "] - ";
-        strcpy(buf, out.c_str());
-        write(fd, buf, strlen(buf));
+    else if (format == DumpFormat::Binary) { appendBinaryHoles(out, holes); }
+    else { // Both lists are sorted by offset, so each difference is one merge pass
+        vector<pair<unsigned, unsigned>> removed, added;
+        set_difference(dumpSnapshot.begin(), dumpSnapshot.end(), holes.begin(), holes.end(), back_inserter(removed));
+        set_difference(holes.begin(), holes.end(), dumpSnapshot.begin(), dumpSnapshot.end(), back_inserter(added));
+        appendBinaryHoles(out, removed);
+        appendBinaryHoles(out, added);
     }
-    out = "[" + to_string(holes[holes.size()-1].first) + ", " + to_string(holes[holes.size()-1].second) + "]";
-    strcpy(buf, out.c_str());
-    write(fd, buf, strlen(buf));
 
+    // Open/create the file, replacing what was there unless appending a record
+    int mode = (format == DumpFormat::Incremental) ? O_APPEND : O_TRUNC;
+    int fd = open(filename, O_CREAT | O_WRONLY | mode, S_IRWXU);
+    if (fd == -1) { return -1; }
+    size_t written = 0;
+    while (written < out.size()) { // A single write() unless it is interrupted partway
+        ssize_t result = write(fd, out.data() + written, out.size() - written);
+        if (result == -1 && errno == EINTR) { continue; }
+        if (result <= 0) { close(fd); return -1; }
+        written += result;
+    }
     close(fd);
+
+    dumpSnapshot = holes;
     return 0;
 }
 
@@ -173,41 +869,116 @@ int MemoryManager::dumpMemoryMap(char* filename) {
 // Offset and length are in words. If no memory has been allocated, the function should return a NULL pointer.
 // Format: [(# holes), (hole 0 offset), (hole 0 length), (hole 1 offset), (hole 1 length), ...] 
 // Example: [3, 0, 10, 12, 2, 20, 6]
+// Entries are uint16_t, or uint32_t with Bits32 offsets.
 void* MemoryManager::getList() {
-    if (memory.size() == 0) { return nullptr; }
+    unique_lock<mutex> lock = lockCentral();
+    if (memoryBytes == 0) { return nullptr; }
+    SharedGuard guard(this, false);
+    refreshHoles();
 
-    int listSize = (holes.size()*2) + 1;
-    uint16_t* holesArray = new uint16_t[listSize];
-    holesArray[0] = holes.size();
-    
-    for (unsigned i = 0; i < holes.size(); i++) {
-        holesArray[(i*2)+1] = holes[i].first;
-        holesArray[(i*2)+2] = holes[i].second;
+    if (offsetWidth == OffsetWidth::Bits32) {
+        uint32_t* holesArray = new uint32_t[wideHoleList.size()];
+        memcpy(holesArray, wideHoleList.data(), wideHoleList.size()*sizeof(uint32_t));
+        return holesArray;
     }
+    uint16_t* holesArray = new uint16_t[holeList.size()];
+    memcpy(holesArray, holeList.data(), holeList.size()*sizeof(uint16_t));
     return holesArray;
 }
 
+// Returns a read-only view of the same hole list without copying it; this is what allocate() passes to the
+// allocator function. The view is owned by the memory manager and is only valid until the next allocate(),
+// free(), initialize() or shutdown() call, so it is not safe to use in concurrent mode. If no memory has been
+// allocated, returns a NULL pointer.
+const void* MemoryManager::getListView() {
+    if (memoryBytes == 0) { return nullptr; }
+    SharedGuard guard(this, false);
+    refreshHoles();
+    return holeListData();
+}
+
 // Returns a bit-stream of bits in terms of an array representing whether words are used (1) or free (0). The
-// first two bytes are the size of the bitmap (little-Endian); the rest is the bitmap, word-wise.
+// first two bytes are the size of the bitmap (little-Endian); the rest is the bitmap, word-wise. With Bits32
+// offsets the size takes the first four bytes instead.
 void* MemoryManager::getBitmap() {
-    if (memory.size() == 0) { return nullptr; }
-    
-    uint16_t size = bitmap.size()/8;
-    uint8_t* bits = new uint8_t[size + 2];
+    unique_lock<mutex> lock = lockCentral();
+    if (memoryBytes == 0) { return nullptr; }
+    SharedGuard guard(this, false);
+
+    uint8_t* bits = new uint8_t[bitmapBytes()];
+    writeBitmap(bits);
+    return bits;
+}
+
+// Returns the bytes getList(buffer, bufferBytes) would write right now, or 0 if no memory has been allocated. The list
+// grows and shrinks with the number of holes, so this is only exact until the next allocate() or free();
+// 2 + (arena size in words) entries are always enough.
+size_t MemoryManager::getListBytes() {
+    unique_lock<mutex> lock = lockCentral();
+    if (memoryBytes == 0) { return 0; }
+    SharedGuard guard(this, false);
+    refreshHoles();
+    if (offsetWidth == OffsetWidth::Bits32) { return wideHoleList.size()*sizeof(uint32_t); }
+    return holeList.size()*sizeof(uint16_t);
+}
+
+// Writes the same hole list as getList() into a caller-owned buffer instead of a new one, so a monitor can poll it
+// without touching the heap. Returns the bytes written, or 0 if no memory has been allocated or the list does not fit
+// in bufferBytes (query getListBytes() and try again).
+size_t MemoryManager::getList(void* buffer, size_t bufferBytes) {
+    unique_lock<mutex> lock = lockCentral();
+    if (memoryBytes == 0) { return 0; }
+    SharedGuard guard(this, false);
+    refreshHoles();
+
+    size_t bytes = (offsetWidth == OffsetWidth::Bits32) ? wideHoleList.size()*sizeof(uint32_t)
+                                                        : holeList.size()*sizeof(uint16_t);
+    if (bytes > bufferBytes) { return 0; }
+    memcpy(buffer, holeListData(), bytes);
+    return bytes;
+}
+
+// Returns the bytes getBitmap(buffer, bufferBytes) writes, or 0 if no memory has been allocated. The size only changes
+// with initialize().
+size_t MemoryManager::getBitmapBytes() {
+    unique_lock<mutex> lock = lockCentral();
+    if (memoryBytes == 0) { return 0; }
+    return bitmapBytes();
+}
+
+// Writes the same bitmap as getBitmap() into a caller-owned buffer instead of a new one. Returns the bytes written, or
+// 0 if no memory has been allocated or the bitmap does not fit in bufferBytes.
+size_t MemoryManager::getBitmap(void* buffer, size_t bufferBytes) {
+    unique_lock<mutex> lock = lockCentral();
+    if (memoryBytes == 0 || bitmapBytes() > bufferBytes) { return 0; }
+    SharedGuard guard(this, false);
+    writeBitmap(static_cast<uint8_t*>(buffer));
+    return bitmapBytes();
+}
+
+// Size of the getBitmap() output in bytes: the size header and one bit per word.
+size_t MemoryManager::bitmapBytes() {
+    return (memSize + 7) / 8 + ((offsetWidth == OffsetWidth::Bits32) ? 4 : 2);
+}
+
+// Writes the getBitmap() layout to bits, which must have room for bitmapBytes().
+void MemoryManager::writeBitmap(uint8_t* bits) {
+    uint32_t size = (memSize + 7) / 8;
+    unsigned header = (offsetWidth == OffsetWidth::Bits32) ? 4 : 2;
 
     // Store size of bitmap (Little-Endian)
-    bits[0] = (uint8_t)(size >> 0);
-    bits[1] = (uint8_t)(size >> 8);
+    for (unsigned i = 0; i < header; i++) {
+        bits[i] = (uint8_t)(size >> (i*8));
+    }
 
-    unsigned byte = 0;
-    for (unsigned i = 0; i < bitmap.size(); i += 8) {
-        for (int j = 7; j >= 0; j--) { // Combine words into bytes representation 
-            byte |= bitmap[i+j] << j; // Reverses order for Little-Endian
-        }
-        bits[(i/8)+2] = (uint8_t)byte;
-        byte = 0;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // Bit i of the packed bitmap already sits in byte i/8 at bit i%8, exactly the output layout
+    memcpy(bits + header, bitmap, size);
+#else
+    for (unsigned i = 0; i < size; i++) { // Pull each byte out of its 64-bit word
+        bits[i+header] = (uint8_t)(bitmap[i/8] >> ((i%8)*8));
     }
-    return bits;
+#endif
 }
 
 // Returns the word size used for alignment.
@@ -217,12 +988,1082 @@ unsigned MemoryManager::getWordSize() {
 
 // Returns the byte-wise memory address of the beginning of the memory block.
 void* MemoryManager::getMemoryStart() {
-    return &memory[0];
+    return memory;
 }
 
 // Returns the byte limit of the current memory block.
-unsigned MemoryManager::getMemoryLimit() {
-    return memory.size();
+size_t MemoryManager::getMemoryLimit() {
+    return memoryBytes;
+}
+
+// Returns true if memory has been initialized and no block is allocated from it. Blocks parked in thread caches in
+// concurrent mode still count as allocated.
+bool MemoryManager::isEmpty() {
+    unique_lock<mutex> lock = lockCentral();
+    SharedGuard guard(this, false);
+    refreshHoles();
+    return memoryBytes != 0 && holes.size() == 1 && holes[0].second == memSize;
+}
+
+// --------------Statistics-------------- //
+
+// Clears every counter; only safe for the single writer.
+void StatCounters::reset() {
+    for (auto* counter : {&allocations, &frees, &failures}) { counter->store(0, memory_order_relaxed); }
+    for (auto& counter : sizeClasses) { counter.store(0, memory_order_relaxed); }
+    for (auto* histogram : {allocateTicks, freeTicks, allocatorTicks}) {
+        for (unsigned i = 0; i < MemoryStats::latencyBucketCount; i++) { histogram[i].store(0, memory_order_relaxed); }
+    }
+}
+
+// Adds every counter of other into this set; only safe for the single writer of this set.
+void StatCounters::merge(const StatCounters& other) {
+    add(allocations, other.allocations.load(memory_order_relaxed));
+    add(frees, other.frees.load(memory_order_relaxed));
+    add(failures, other.failures.load(memory_order_relaxed));
+    for (unsigned i = 0; i < MemoryStats::sizeClassCount; i++) {
+        add(sizeClasses[i], other.sizeClasses[i].load(memory_order_relaxed));
+    }
+    for (unsigned i = 0; i < MemoryStats::latencyBucketCount; i++) {
+        add(allocateTicks[i], other.allocateTicks[i].load(memory_order_relaxed));
+        add(freeTicks[i], other.freeTicks[i].load(memory_order_relaxed));
+        add(allocatorTicks[i], other.allocatorTicks[i].load(memory_order_relaxed));
+    }
+}
+
+// Returns the power-of-two bucket of value: 0 for 0 and 1, otherwise floor(log2(value)), capped at the last bucket.
+static unsigned logBucket(uint64_t value) {
+    unsigned bucket = (value <= 1) ? 0 : 63 - __builtin_clzll(value);
+    return min(bucket, MemoryStats::latencyBucketCount - 1);
+}
+
+// Adds one set of event counters into a snapshot.
+static void addCounters(MemoryStats& stats, const StatCounters& source) {
+    stats.allocations += source.allocations.load(memory_order_relaxed);
+    stats.frees += source.frees.load(memory_order_relaxed);
+    stats.failures += source.failures.load(memory_order_relaxed);
+    for (unsigned i = 0; i < MemoryStats::sizeClassCount; i++) {
+        stats.sizeClasses[i] += source.sizeClasses[i].load(memory_order_relaxed);
+    }
+    for (unsigned i = 0; i < MemoryStats::latencyBucketCount; i++) {
+        stats.allocateTicks[i] += source.allocateTicks[i].load(memory_order_relaxed);
+        stats.freeTicks[i] += source.freeTicks[i].load(memory_order_relaxed);
+        stats.allocatorTicks[i] += source.allocatorTicks[i].load(memory_order_relaxed);
+    }
+}
+
+// Returns allocation counters, bytes in use, hole and fragmentation figures in one snapshot, without building a hole
+// list.
+MemoryStats MemoryManager::getStats() {
+    unique_lock<mutex> lock = lockCentral();
+    SharedGuard guard(this, false);
+
+    MemoryStats stats = {};
+    addCounters(stats, counters);
+    for (auto& cache : threadCaches) { addCounters(stats, cache->counters); }
+
+    stats.bytesInUse = wordsInUse*wordSize;
+    stats.peakBytesInUse = peakWordsInUse*wordSize;
+    stats.holeCount = (engine == Engine::HoleList) ? holes.size() : engineHoles;
+    size_t largestWords = 0;
+    if (engine == Engine::Buddy) { // Only a whole free block can be handed out
+        if (nonEmptyOrders != 0) { largestWords = 1u << (31 - __builtin_clz(nonEmptyOrders)); }
+    }
+    else if (engine == Engine::TLSF) { largestWords = largestTlsfBlock(); }
+    else if (!holesBySize.empty()) { largestWords = holesBySize.rbegin()->first; } // Indexed policies know it already
+    else {
+        for (auto& hole : holes) { largestWords = max(largestWords, (size_t)hole.second); }
+    }
+    stats.largestHole = largestWords*wordSize;
+    size_t freeWords = memSize - wordsInUse;
+    stats.fragmentation = (freeWords == 0) ? 0.0 : 1.0 - (double)largestWords / freeWords;
+    return stats;
+}
+
+// Switches the latency histograms of getStats() on or off. Sampling reads the time-stamp counter twice per call, so it
+// is off by default. Safe to call while other threads use the memory manager; calls already under way keep the setting
+// they started with.
+void MemoryManager::setLatencySampling(bool sampling) {
+    latencySampling.store(sampling, memory_order_relaxed);
+}
+
+// Returns the counters the calling thread should write outside the central lock: its own cache's in concurrent mode,
+// the manager's otherwise. Code holding the central lock writes the manager's counters directly, as it may not
+// create a cache.
+StatCounters& MemoryManager::statCounters() {
+    if (!concurrent) { return counters; }
+    return threadCache()->counters;
+}
+
+// Counts blocks handed out for requests of sizeInBytes in target, and a failure if the request could not be met in
+// full.
+void MemoryManager::countAllocations(StatCounters& target, size_t sizeInBytes, uint64_t blocks, bool failed) {
+    if (blocks != 0) {
+        StatCounters::add(target.allocations, blocks);
+        unsigned sizeClass = (sizeInBytes <= 1) ? 0 : logBucket(sizeInBytes - 1) + 1;
+        StatCounters::add(target.sizeClasses[min(sizeClass, MemoryStats::sizeClassCount - 1)], blocks);
+    }
+    if (failed) { StatCounters::add(target.failures, 1); }
+}
+
+// Counts a call that started at startTicks in histogram.
+void MemoryManager::countLatency(atomic<uint64_t>* histogram, uint64_t startTicks) {
+    StatCounters::add(histogram[logBucket(readTicks() - startTicks)], 1);
+}
+
+// Adds words to the words in use, raising the peak if needed. The central lock must be held in concurrent mode.
+void MemoryManager::useWords(size_t words) {
+    wordsInUse += words;
+    peakWordsInUse = max(peakWordsInUse, wordsInUse);
+}
+
+// --------------Deferred free-------------- //
+
+// Switches deferred free mode on or off; must be called while no other thread is using the memory manager. In deferred
+// mode a freed block is not coalesced: it goes onto a quick list for its length and the next allocation of that many
+// words takes it back in O(1). Queued blocks are merged into the holes in a single sort-merge pass once
+// deferredFreeLimit of them are waiting, when an allocation finds no hole, on flushDeferredFrees(), and when the mode
+// is switched off. Like cached blocks, queued blocks still count as allocated in getList(), getBitmap(),
+// dumpMemoryMap() and getStats(). Only the HoleList engine defers frees, and it is not available on a persistent arena.
+void MemoryManager::setDeferredFree(bool deferred) {
+    if (shared != nullptr || engine != Engine::HoleList) { return; }
+    unique_lock<mutex> lock = lockCentral();
+    if (!deferred) { flushDeferred(); }
+    deferFrees = deferred;
+}
+
+// Merges every block queued by deferred free mode into the holes.
+void MemoryManager::flushDeferredFrees() {
+    unique_lock<mutex> lock = lockCentral();
+    flushDeferred();
+}
+
+// Queues the partition of length words at wordOffset on the quick list for its length, merging the queue once it is
+// full.
+void MemoryManager::deferWords(unsigned wordOffset, unsigned length) {
+    quickLists[length].push_back(wordOffset);
+    if (++deferredCount >= deferredFreeLimit) { flushDeferred(); }
+}
+
+// Unlocked body of flushDeferredFrees(): releases every queued partition and merges them all in one pass.
+void MemoryManager::flushDeferred() {
+    if (deferredCount == 0) { return; }
+    vector<pair<unsigned, unsigned>> runs;
+    runs.reserve(deferredCount);
+    for (auto& queue : quickLists) {
+        for (unsigned wordOffset : queue.second) {
+            runs.push_back(make_pair(wordOffset, queue.first));
+            markWords(wordOffset, queue.first, false);
+            partitions[wordOffset] = 0;
+        }
+        wordsInUse -= (size_t)queue.first * queue.second.size();
+        queue.second.clear();
+    }
+    deferredCount = 0;
+    mergeRuns(runs);
+}
+
+// --------------Handles and compaction-------------- //
+
+// Allocates like allocate(), but returns a handle instead of an address so that compact() can move the block while it
+// is not pinned. Returns 0 if no hole can fit the block. A handle's block must only be freed with freeHandle(), never
+// passed to free() or reallocate().
+Handle MemoryManager::allocateHandle(size_t sizeInBytes) {
+    // Check for invalid allocation
+    if (sizeInBytes > memSize*wordSize || sizeInBytes == 0 || memoryBytes == 0) { return 0; }
+
+    unsigned words = (sizeInBytes + wordSize - 1) / wordSize; // Round up to whole words
+
+    // Handle blocks must be real partitions that compact() can find, so they always come from the holes
+    unique_lock<mutex> lock = lockCentral();
+    SharedGuard guard(this, true);
+    void* block = allocateWords(words, 1);
+    if (tracer) { traceEvent(TraceEvent::Allocate, sizeInBytes, block, lastHole); }
+    countAllocations(counters, sizeInBytes, block != nullptr, block == nullptr);
+    if (block == nullptr) { return 0; }
+
+    Handle handle;
+    if (!freeHandles.empty()) {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    }
+    else {
+        handles.push_back(HandleEntry());
+        handle = handles.size();
+    }
+    unsigned wordOffset = ((char*)block - &memory[0]) / wordSize;
+    handles[handle - 1] = {wordOffset, 0, true};
+    relocatable[wordOffset] = handle;
+    return handle;
+}
+
+// Returns the current address of handle's block and keeps the block from moving until the matching unpin(). Pins
+// nest, and the address is only stable while pinned. Returns nullptr for an invalid handle.
+void* MemoryManager::pin(Handle handle) {
+    unique_lock<mutex> lock = lockCentral();
+    HandleEntry* entry = handleEntry(handle);
+    if (entry == nullptr) { return nullptr; }
+    entry->pins++;
+    return &memory[(size_t)entry->wordOffset*wordSize];
+}
+
+// Releases one pin() of handle, letting compact() move its block once no pins are left.
+void MemoryManager::unpin(Handle handle) {
+    unique_lock<mutex> lock = lockCentral();
+    HandleEntry* entry = handleEntry(handle);
+    if (entry != nullptr && entry->pins > 0) { entry->pins--; }
+}
+
+// Frees handle's block, pinned or not. The handle becomes invalid and may be returned again by allocateHandle().
+void MemoryManager::freeHandle(Handle handle) {
+    unique_lock<mutex> lock = lockCentral();
+    SharedGuard guard(this, true);
+    HandleEntry* entry = handleEntry(handle);
+    if (entry == nullptr) { return; }
+
+    void* address = &memory[(size_t)entry->wordOffset*wordSize];
+    if (tracer) {
+        traceEvent(TraceEvent::Free, (uint64_t)partitions[entry->wordOffset]*wordSize, address, TraceRecord::noOffset);
+    }
+    relocatable.erase(entry->wordOffset);
+    freeWords(entry->wordOffset, partitions[entry->wordOffset]);
+    StatCounters::add(counters.frees, 1);
+    entry->live = false;
+    freeHandles.push_back(handle);
+}
+
+// Runs an incremental compaction pass for about budget: unpinned handle blocks slide down into the hole right before
+// them, one at a time, so free space collects into fewer, larger holes. Blocks from allocate() and pinned handles stay
+// put and the pass carries on past them. Each call resumes where the last one stopped and takes at least one step, and
+// returns true once the pass has reached the end of the arena (the next call starts over). Only the HoleList engine
+// compacts; Buddy arenas and persistent arenas return true at once.
+bool MemoryManager::compact(chrono::microseconds budget) {
+    unique_lock<mutex> lock = lockCentral();
+    if (engine != Engine::HoleList || shared != nullptr || memoryBytes == 0) { return true; }
+    flushDeferred(); // Queued blocks are immovable partitions until they are merged
+
+    auto deadline = chrono::steady_clock::now() + budget;
+    for (bool first = true; ; first = false) {
+        if (!first && chrono::steady_clock::now() >= deadline) { return false; }
+
+        // Holes are merged, so the first hole from the cursor on is followed by a partition or the end of the arena
+        unsigned index = lower_bound(holes.begin(), holes.end(), make_pair(compactCursor, 0u)) - holes.begin();
+        unsigned wordOffset = (index == holes.size()) ? memSize : holes[index].first + holes[index].second;
+        if (wordOffset >= memSize) { // Pass complete
+            compactCursor = 0;
+            return true;
+        }
+
+        auto handle = relocatable.find(wordOffset);
+        if (handle == relocatable.end() || handles[handle->second - 1].pins != 0) { // Fixed, carry on past it
+            compactCursor = wordOffset + partitions[wordOffset];
+            continue;
+        }
+        slidePartition(index, handle->second);
+    }
+}
+
+// Returns the entry of a live handle, or nullptr if handle is not one.
+MemoryManager::HandleEntry* MemoryManager::handleEntry(Handle handle) {
+    if (handle == 0 || handle > handles.size() || !handles[handle - 1].live) { return nullptr; }
+    return &handles[handle - 1];
+}
+
+// Moves handle's partition, which starts right after hole index, down to the start of that hole. The hole moves up
+// past the partition and merges with the hole after it, if any.
+void MemoryManager::slidePartition(unsigned index, Handle handle) {
+    unsigned start = holes[index].first;
+    unsigned gap = holes[index].second;
+    unsigned wordOffset = start + gap;
+    unsigned length = partitions[wordOffset];
+
+    memmove(&memory[(size_t)start*wordSize], &memory[(size_t)wordOffset*wordSize], (size_t)length*wordSize);
+    partitions[wordOffset] = 0;
+    partitions[start] = length;
+    markWords(wordOffset, length, false);
+    markWords(start, length, true);
+    relocatable.erase(wordOffset);
+    relocatable[start] = handle;
+    handles[handle - 1].wordOffset = start;
+
+    if (index + 1 < holes.size() && holes[index + 1].first == wordOffset + length) {
+        setHole(index, start + length, gap + holes[index + 1].second);
+        eraseHole(index + 1);
+    }
+    else {
+        setHole(index, start + length, gap);
+    }
+}
+
+// --------------Trace recording-------------- //
+
+// Starts recording every allocation, free and setAllocator() call to filename in the TraceRecorder format, replacing
+// any trace already running. Records are buffered in a lock-free ring and written by a background thread. Batch calls
+// are recorded block by block, and a reallocate() as a free of the old block followed by an allocation of the new
+// size. Must not race with other calls. Returns false if the file cannot be created.
+bool MemoryManager::startTrace(const char* filename) {
+    stopTrace();
+    unique_ptr<TraceRecorder> recorder(new TraceRecorder(filename, wordSize));
+    if (!recorder->isOpen()) { return false; }
+    tracer = move(recorder);
+    return true;
+}
+
+// Stops the running trace once every buffered record has been written, and returns how many records were dropped
+// because the ring was full. Must not race with other calls.
+uint64_t MemoryManager::stopTrace() {
+    if (!tracer) { return 0; }
+    uint64_t dropped = tracer->stop();
+    tracer.reset();
+    return dropped;
+}
+
+// Records an event for the block at address, or for no block if address is nullptr (a failed allocation).
+void MemoryManager::traceEvent(TraceEvent event, uint64_t size, void* address, uint32_t hole) {
+    uint32_t offset = (address == nullptr) ? TraceRecord::noOffset : ((char*)address - memory) / wordSize;
+    tracer->record(event, size, offset, (address == nullptr) ? TraceRecord::noOffset : hole);
+}
+
+// --------------Concurrent mode-------------- //
+
+// Switches concurrent mode on or off; must be called while no other thread is using the memory manager. In
+// concurrent mode every function may be called from any thread. Blocks of up to threadCacheClasses words are
+// freed into a cache owned by the calling thread and reused by its next allocation of the same size; only
+// refilling a cache, flushing a full one, and larger blocks take the central lock. Cached blocks still count
+// as allocated in getList(), getBitmap() and dumpMemoryMap(). A thread's cache is flushed and dropped when the
+// thread exits (its counts stay in getStats()), and discarded by initialize() and shutdown(), which must not
+// race with other threads. The lock is one for the whole arena rather than one per size class, as every class
+// carves from the same holes and bitmap; a refill carves its whole batch in one pass to hold it briefly.
+void MemoryManager::setConcurrent(bool concurrent) {
+    if (concurrent == this->concurrent || shared != nullptr) { return; }
+
+    lock_guard<mutex> lock(registryLock());
+    if (concurrent) { registry()[id] = this; }
+    else { // Hand every cached block back before the caches go away
+        registry().erase(id);
+        for (auto& cache : threadCaches) { flushThreadCache(cache.get()); }
+    }
+    this->concurrent = concurrent;
+}
+
+// Takes the central lock in concurrent mode; otherwise returns an empty lock and costs nothing.
+unique_lock<mutex> MemoryManager::lockCentral() {
+    if (!concurrent) { return unique_lock<mutex>(); }
+    return unique_lock<mutex>(centralLock);
+}
+
+// Returns the calling thread's cache for this memory manager, creating it on first use.
+ThreadCache* MemoryManager::threadCache() {
+    for (auto& entry : threadCacheHandle.caches) {
+        if (entry.first == id) { return entry.second; }
+    }
+
+    lock_guard<mutex> lock(centralLock);
+    threadCaches.push_back(unique_ptr<ThreadCache>(new ThreadCache()));
+    threadCacheHandle.caches.push_back(make_pair(id, threadCaches.back().get()));
+    return threadCaches.back().get();
+}
+
+// Serves small blocks from the calling thread's cache, refilling it when it runs dry with a batch carved from the
+// holes in one pass, so the central lock is taken once per threadCacheRefill blocks.
+void* MemoryManager::cachedAllocate(unsigned sizeInWords) {
+    if (sizeInWords > threadCacheClasses) {
+        lock_guard<mutex> lock(centralLock);
+        return allocateWords(sizeInWords, 1);
+    }
+
+    ThreadCache* cache = threadCache();
+    vector<void*>& bin = cache->bins[sizeInWords - 1];
+    if (bin.empty()) {
+        lock_guard<mutex> lock(centralLock);
+        bin.resize(threadCacheRefill);
+        bin.resize(carveWords(threadCacheRefill, sizeInWords, bin.data(), 0));
+        reverse(bin.begin(), bin.end()); // Hand out the lowest block first, as separate allocations would
+
+        // Out of space - give back what this thread is hoarding in other size classes and try once more
+        if (bin.empty()) {
+            flushThreadCache(cache);
+            return allocateWords(sizeInWords, 1);
+        }
+    }
+
+    void* block = bin.back();
+    bin.pop_back();
+    return block;
+}
+
+// Keeps small freed blocks in the calling thread's cache, flushing the older half of the bin when it fills up.
+void MemoryManager::cachedFree(unsigned wordOffset, unsigned length) {
+    if (length > threadCacheClasses) {
+        lock_guard<mutex> lock(centralLock);
+        return freeWords(wordOffset, length);
+    }
+
+    vector<void*>& bin = threadCache()->bins[length - 1];
+    bin.push_back(&memory[(size_t)wordOffset*wordSize]);
+    if (bin.size() > threadCacheDepth) {
+        lock_guard<mutex> lock(centralLock);
+        for (unsigned i = 0; i < threadCacheDepth/2; i++) {
+            unsigned offset = ((char*)bin[i] - &memory[0]) / wordSize;
+            freeWords(offset, partitions[offset]);
+        }
+        bin.erase(bin.begin(), bin.begin() + threadCacheDepth/2);
+    }
+}
+
+// Frees every block in a thread cache back into the holes. The central lock must be held in concurrent mode. A bin
+// holds blocks of at least its size, as the Buddy and TLSF engines round up the blocks of a refill, so each block's
+// length is looked up.
+void MemoryManager::flushThreadCache(ThreadCache* cache) {
+    for (auto& bin : cache->bins) {
+        for (void* block : bin) {
+            unsigned offset = ((char*)block - &memory[0]) / wordSize;
+            freeWords(offset, partitions[offset]);
+        }
+        bin.clear();
+    }
+}
+
+// Flushes the cache of an exiting thread, folds its counters into the manager's and drops it, so threadCaches only
+// holds the caches of live threads however many come and go. The central lock must be held.
+void MemoryManager::retireThreadCache(ThreadCache* cache) {
+    flushThreadCache(cache);
+    counters.merge(cache->counters);
+    for (size_t i = 0; i < threadCaches.size(); i++) {
+        if (threadCaches[i].get() != cache) { continue; }
+        threadCaches[i].swap(threadCaches.back());
+        threadCaches.pop_back();
+        return;
+    }
+}
+
+// --------------Free block tags-------------- //
+
+// Reads a field of the tag at the start of the free block at offset. Tags are copied in and out with memcpy, as words
+// need not be four-byte aligned.
+uint32_t MemoryManager::readTag(unsigned offset, unsigned field) {
+    uint32_t value;
+    memcpy(&value, &memory[(size_t)offset*wordSize + field*sizeof(uint32_t)], sizeof(value));
+    return value;
+}
+
+// Writes a field of the tag at the start of the free block at offset.
+void MemoryManager::writeTag(unsigned offset, unsigned field, uint32_t value) {
+    memcpy(&memory[(size_t)offset*wordSize + field*sizeof(uint32_t)], &value, sizeof(value));
+}
+
+// Returns the start of the TLSF free block ending right before word end, kept in the block's last four bytes.
+unsigned MemoryManager::readTail(unsigned end) {
+    uint32_t start;
+    memcpy(&start, &memory[(size_t)end*wordSize - sizeof(uint32_t)], sizeof(start));
+    return start;
+}
+
+// Writes the start of a TLSF free block into its last four bytes.
+void MemoryManager::writeTail(unsigned offset, unsigned length) {
+    uint32_t start = offset;
+    memcpy(&memory[(size_t)(offset + length)*wordSize - sizeof(uint32_t)], &start, sizeof(start));
+}
+
+// Returns true if the bitmap has the word at offset free.
+bool MemoryManager::wordFree(unsigned offset) {
+    return (bitmap[offset/64] >> (offset % 64) & 1) == 0;
+}
+
+// Sets up the free structures of the Buddy or TLSF engine from holes, writing every free block's tags.
+void MemoryManager::initializeEngine() {
+    if (engine == Engine::Buddy) { buddyInitialize(); }
+    else if (engine == Engine::TLSF) { tlsfInitialize(); }
+}
+
+// --------------Buddy engine-------------- //
+
+// Returns the order of the largest naturally aligned power-of-two block that starts at offset and ends by end.
+unsigned MemoryManager::buddyBlockOrder(unsigned offset, unsigned end) {
+    unsigned order = (offset == 0) ? 31 : __builtin_ctz(offset);
+    while (offset + (1ull << order) > end) { order--; }
+    return order;
+}
+
+// Splits every hole (the whole arena, unless rebuilding a persistent one) into the largest naturally aligned
+// power-of-two blocks that fit, so sizes that are not a power of two still use every word. Blocks are at least
+// minBlockWords long so a tag fits in them; blocks too small are left out of the free lists, and since every block
+// handed out is aligned to minBlockWords, those can only be the last few words of the arena.
+void MemoryManager::buddyInitialize() {
+    minBlockWords = 1;
+    while ((size_t)minBlockWords*wordSize < tagBytes) { minBlockWords *= 2; }
+    fill(freeHeads, freeHeads + 32, UINT_MAX);
+    nonEmptyOrders = 0;
+    engineHoles = holes.size();
+
+    for (auto& hole : holes) {
+        unsigned end = hole.first + hole.second;
+        for (unsigned offset = hole.first; offset < end;) {
+            unsigned order = buddyBlockOrder(offset, end);
+            if ((1u << order) >= minBlockWords) { pushFreeBlock(order, offset); }
+            offset += 1u << order;
+        }
+    }
+}
+
+// Takes the smallest free block that fits, splitting it in halves down to the requested order. Blocks sit at
+// multiples of their own size from the page-aligned arena start, so alignment only needs a big enough order.
+void* MemoryManager::buddyAllocate(unsigned sizeInWords, size_t alignment) {
+    if (alignment > arenaAlignment) { return nullptr; }
+    unsigned order = (sizeInWords == 1) ? 0 : 32 - __builtin_clz(sizeInWords - 1); // Round up to a power of two
+    order = max(order, (unsigned)__builtin_ctz(minBlockWords)); // Room for a tag once the block is freed
+    while (order < 31 && ((size_t)wordSize << order) % alignment != 0) { order++; }
+    if (((size_t)wordSize << order) % alignment != 0) { return nullptr; }
+    uint32_t candidates = nonEmptyOrders & (UINT32_MAX << order);
+    if (candidates == 0) { return nullptr; } // No free block is large enough
+
+    unsigned blockOrder = __builtin_ctz(candidates);
+    unsigned offset = freeHeads[blockOrder];
+    removeFreeBlock(blockOrder, offset);
+    lastHole = offset;
+    while (blockOrder > order) { // Keep the lower half, free the upper half as its buddy
+        blockOrder--;
+        pushFreeBlock(blockOrder, offset + (1u << blockOrder));
+    }
+
+    partitions[offset] = 1u << order;
+    markEngineWords(offset, 1u << order, true);
+    useWords(1u << order);
+    holesStale = true;
+    return &memory[(size_t)offset*wordSize];
+}
+
+// Frees a block and merges it with its buddy (offset XOR size) for as long as the buddy is free and whole. A free word
+// at the buddy's offset can only be the start of a free block no larger than the buddy, as a larger one would cover
+// the block being freed, so its tag tells whether the whole buddy is free.
+void MemoryManager::buddyFree(unsigned wordOffset, unsigned length) {
+    unsigned order = __builtin_ctz(length);
+    partitions[wordOffset] = 0;
+    markEngineWords(wordOffset, length, false);
+    wordsInUse -= length;
+
+    while (order < 31) {
+        unsigned buddy = wordOffset ^ (1u << order);
+        if (buddy + (1ull << order) > memSize || !wordFree(buddy) || readTag(buddy, tagSize) != order) { break; }
+        removeFreeBlock(order, buddy);
+        wordOffset = min(wordOffset, buddy);
+        order++;
+    }
+    pushFreeBlock(order, wordOffset);
+    holesStale = true;
+}
+
+// Resizes a block without moving it. Shrinking keeps the lower part and frees the upper halves, which cannot merge
+// since their buddies are still in use. Growing doubles the block while each buddy above it is free and whole.
+bool MemoryManager::buddyResize(unsigned wordOffset, unsigned sizeInWords) {
+    unsigned length = partitions[wordOffset];
+    unsigned order = __builtin_ctz(length);
+    unsigned newOrder = (sizeInWords == 1) ? 0 : 32 - __builtin_clz(sizeInWords - 1); // Round up to a power of two
+    newOrder = max(newOrder, (unsigned)__builtin_ctz(minBlockWords));
+    if (newOrder == order) { return true; }
+
+    if (newOrder < order) {
+        for (unsigned split = order; split > newOrder; split--) {
+            pushFreeBlock(split - 1, wordOffset + (1u << (split - 1)));
+        }
+        markEngineWords(wordOffset + (1u << newOrder), length - (1u << newOrder), false);
+        wordsInUse -= length - (1u << newOrder);
+    }
+    else {
+        if (newOrder > 31 || wordOffset % (1ull << newOrder) != 0) { return false; } // Not aligned for the new order
+        if (wordOffset + (1ull << newOrder) > memSize) { return false; }
+        for (unsigned merge = order; merge < newOrder; merge++) {
+            unsigned buddy = wordOffset + (1u << merge);
+            if (!wordFree(buddy) || readTag(buddy, tagSize) != merge) { return false; }
+        }
+        for (unsigned merge = order; merge < newOrder; merge++) {
+            removeFreeBlock(merge, wordOffset + (1u << merge));
+        }
+        markEngineWords(wordOffset + length, (1u << newOrder) - length, true);
+        useWords((1u << newOrder) - length);
+    }
+
+    partitions[wordOffset] = 1u << newOrder;
+    holesStale = true;
+    return true;
+}
+
+// Adds a free block to the front of its order's free list.
+void MemoryManager::pushFreeBlock(unsigned order, unsigned offset) {
+    unsigned next = freeHeads[order];
+    writeTag(offset, tagPrevious, UINT_MAX);
+    writeTag(offset, tagNext, next);
+    writeTag(offset, tagSize, order);
+    if (next != UINT_MAX) { writeTag(next, tagPrevious, offset); }
+    freeHeads[order] = offset;
+    nonEmptyOrders |= 1u << order;
+}
+
+// Unlinks a free block from its order's free list in O(1).
+void MemoryManager::removeFreeBlock(unsigned order, unsigned offset) {
+    unsigned previous = readTag(offset, tagPrevious), next = readTag(offset, tagNext);
+    if (previous != UINT_MAX) { writeTag(previous, tagNext, next); }
+    else { freeHeads[order] = next; }
+    if (next != UINT_MAX) { writeTag(next, tagPrevious, previous); }
+    if (freeHeads[order] == UINT_MAX) { nonEmptyOrders &= ~(1u << order); }
+}
+
+// --------------TLSF engine-------------- //
+
+// Turns every hole (the whole arena, unless rebuilding a persistent one) into a free block. Free blocks are at least
+// minBlockWords long, room for a tag at the front and the start at the back; only an arena smaller than that has a
+// hole too small, and nothing can be allocated from it.
+void MemoryManager::tlsfInitialize() {
+    minBlockWords = (tagBytes + sizeof(uint32_t) + wordSize - 1) / wordSize;
+    for (auto& level : tlsfHeads) { fill(level, level + tlsfSecondLevels, UINT_MAX); }
+    firstLevelMap = 0;
+    fill(secondLevelMaps, secondLevelMaps + tlsfFirstLevels, 0);
+    engineHoles = holes.size();
+
+    for (auto& hole : holes) {
+        if (hole.second >= minBlockWords) { insertTlsfBlock(hole.first, hole.second); }
+    }
+}
+
+// Takes a free block big enough for the request, with room for the alignment padding, and splits the padding and the
+// rest of the block back off as free blocks. Padding and a rest too small to be free blocks of their own are avoided:
+// the block moves past short padding and takes a short rest.
+void* MemoryManager::tlsfAllocate(unsigned sizeInWords, size_t alignment) {
+    if (alignment > arenaAlignment) { return nullptr; }
+    size_t padding = maxAlignPadding(alignment);
+    if (padding == UINT_MAX) { return nullptr; }
+    if (padding != 0) { padding += minBlockWords; }
+    sizeInWords = max(sizeInWords, minBlockWords); // Room for the tags once the block is freed
+    size_t needed = sizeInWords + padding;
+    if (needed > memSize) { return nullptr; }
+    unsigned start = findTlsfBlock(needed);
+    if (start == UINT_MAX) { return nullptr; } // No free block is large enough
+
+    unsigned end = start + readTag(start, tagSize);
+    removeTlsfBlock(start);
+    unsigned offset = alignOffset(start, alignment);
+    if (offset > start && offset - start < minBlockWords) { offset = alignOffset(start + minBlockWords, alignment); }
+    if (offset > start) { insertTlsfBlock(start, offset - start); }
+    if (end - offset - sizeInWords < minBlockWords) { sizeInWords = end - offset; }
+    else { insertTlsfBlock(offset + sizeInWords, end - offset - sizeInWords); }
+
+    lastHole = start;
+    partitions[offset] = sizeInWords;
+    markEngineWords(offset, sizeInWords, true);
+    useWords(sizeInWords);
+    holesStale = true;
+    return &memory[(size_t)offset*wordSize];
+}
+
+// Returns the start of a free block of at least needed words, or UINT_MAX. The request is rounded up to the next class
+// boundary, so the first block of the first non-empty class at or above it always fits; classes are found with one
+// find-first-set on each bitmap level, so the cost does not depend on how many free blocks there are. Only if that
+// finds nothing is the request's own class walked, as it can still hold a block big enough, such as the whole arena.
+unsigned MemoryManager::findTlsfBlock(size_t needed) {
+    size_t rounded = needed;
+    if (rounded >= tlsfSecondLevels) { rounded += (1ull << (63 - __builtin_clzll(rounded) - tlsfSecondLevelBits)) - 1; }
+    unsigned firstLevel, secondLevel;
+    if (rounded <= INT_MAX) {
+        tlsfClass(rounded, firstLevel, secondLevel);
+        uint32_t candidates = secondLevelMaps[firstLevel] & (UINT32_MAX << secondLevel);
+        if (candidates == 0) { // Nothing big enough in this range, take the smallest class of a larger one
+            uint32_t levels = firstLevelMap & (UINT32_MAX << (firstLevel + 1));
+            if (levels != 0) {
+                firstLevel = __builtin_ctz(levels);
+                candidates = secondLevelMaps[firstLevel];
+            }
+        }
+        if (candidates != 0) { return tlsfHeads[firstLevel][__builtin_ctz(candidates)]; }
+    }
+
+    tlsfClass(needed, firstLevel, secondLevel);
+    for (unsigned offset = tlsfHeads[firstLevel][secondLevel]; offset != UINT_MAX; offset = readTag(offset, tagNext)) {
+        if (readTag(offset, tagSize) >= needed) { return offset; }
+    }
+    return UINT_MAX;
+}
+
+// Frees a block, merging it with the free blocks right before and after it. Free blocks never touch, so a free word
+// right after the block starts a free block and one right before it ends one, whose tags give their extent.
+void MemoryManager::tlsfFree(unsigned wordOffset, unsigned length) {
+    partitions[wordOffset] = 0;
+    markEngineWords(wordOffset, length, false);
+    wordsInUse -= length;
+
+    unsigned end = wordOffset + length;
+    if (end < memSize && wordFree(end)) {
+        length += readTag(end, tagSize);
+        removeTlsfBlock(end);
+    }
+    if (wordOffset > 0 && wordFree(wordOffset - 1)) {
+        unsigned previous = readTail(wordOffset);
+        length += wordOffset - previous;
+        removeTlsfBlock(previous);
+        wordOffset = previous;
+    }
+    insertTlsfBlock(wordOffset, length);
+    holesStale = true;
+}
+
+// Resizes a block without moving it. Shrinking frees the tail, which merges with a free block after it; growing takes
+// words from the front of the free block right after the block, if it is big enough. A tail or remainder too small to
+// be a free block of its own stays with the block.
+bool MemoryManager::tlsfResize(unsigned wordOffset, unsigned sizeInWords) {
+    unsigned length = partitions[wordOffset];
+    unsigned end = wordOffset + length;
+    sizeInWords = max(sizeInWords, minBlockWords);
+    if (sizeInWords == length) { return true; }
+
+    if (sizeInWords < length) { // Turn the tail into a partition of its own and free it like any other
+        if (length - sizeInWords < minBlockWords && (end == memSize || !wordFree(end))) { return true; }
+        partitions[wordOffset] = sizeInWords;
+        partitions[wordOffset + sizeInWords] = length - sizeInWords;
+        tlsfFree(wordOffset + sizeInWords, length - sizeInWords);
+        return true;
+    }
+
+    if (end >= memSize || !wordFree(end)) { return false; }
+    unsigned available = readTag(end, tagSize), extra = sizeInWords - length;
+    if (available < extra) { return false; }
+    removeTlsfBlock(end);
+    if (available - extra < minBlockWords) { extra = available; }
+    else { insertTlsfBlock(end + extra, available - extra); }
+    partitions[wordOffset] = length + extra;
+    markEngineWords(end, extra, true);
+    useWords(extra);
+    holesStale = true;
+    return true;
+}
+
+// Adds a free block to the front of its class's list and tags both of its ends.
+void MemoryManager::insertTlsfBlock(unsigned offset, unsigned length) {
+    unsigned firstLevel, secondLevel;
+    tlsfClass(length, firstLevel, secondLevel);
+    unsigned next = tlsfHeads[firstLevel][secondLevel];
+    writeTag(offset, tagPrevious, UINT_MAX);
+    writeTag(offset, tagNext, next);
+    writeTag(offset, tagSize, length);
+    writeTail(offset, length);
+    if (next != UINT_MAX) { writeTag(next, tagPrevious, offset); }
+    tlsfHeads[firstLevel][secondLevel] = offset;
+    firstLevelMap |= 1u << firstLevel;
+    secondLevelMaps[firstLevel] |= 1u << secondLevel;
+}
+
+// Unlinks a free block from its class's list in O(1).
+void MemoryManager::removeTlsfBlock(unsigned offset) {
+    unsigned firstLevel, secondLevel;
+    tlsfClass(readTag(offset, tagSize), firstLevel, secondLevel);
+    unsigned previous = readTag(offset, tagPrevious), next = readTag(offset, tagNext);
+    if (previous != UINT_MAX) { writeTag(previous, tagNext, next); }
+    else { tlsfHeads[firstLevel][secondLevel] = next; }
+    if (next != UINT_MAX) { writeTag(next, tagPrevious, previous); }
+    if (tlsfHeads[firstLevel][secondLevel] == UINT_MAX) {
+        secondLevelMaps[firstLevel] &= ~(1u << secondLevel);
+        if (secondLevelMaps[firstLevel] == 0) { firstLevelMap &= ~(1u << firstLevel); }
+    }
+}
+
+// Maps a block length to its class. Lengths below tlsfSecondLevels get a class each in first level 0; above that,
+// first level f + 1 - tlsfSecondLevelBits holds lengths [2^f, 2^(f+1)), split by the next tlsfSecondLevelBits bits.
+void MemoryManager::tlsfClass(unsigned length, unsigned& firstLevel, unsigned& secondLevel) {
+    if (length < tlsfSecondLevels) {
+        firstLevel = 0;
+        secondLevel = length;
+        return;
+    }
+    unsigned topBit = 31 - __builtin_clz(length);
+    firstLevel = topBit + 1 - tlsfSecondLevelBits;
+    secondLevel = (length >> (topBit - tlsfSecondLevelBits)) ^ tlsfSecondLevels;
+}
+
+// Returns the length of the largest TLSF free block, or 0 if there is none. Only the top non-empty class can hold it,
+// so only that class's list is walked.
+unsigned MemoryManager::largestTlsfBlock() {
+    if (firstLevelMap == 0) { return 0; }
+    unsigned firstLevel = 31 - __builtin_clz(firstLevelMap);
+    unsigned secondLevel = 31 - __builtin_clz(secondLevelMaps[firstLevel]);
+    unsigned largest = 0;
+    for (unsigned offset = tlsfHeads[firstLevel][secondLevel]; offset != UINT_MAX; offset = readTag(offset, tagNext)) {
+        largest = max(largest, readTag(offset, tagSize));
+    }
+    return largest;
+}
+
+// Marks the words of a block that is handed out or freed like markWords(), counting holes split or merged. A freed
+// block is a new hole unless it touches free words on either side, which it joins; a block handed out does the
+// reverse.
+void MemoryManager::markEngineWords(unsigned offset, unsigned length, bool used) {
+    unsigned end = offset + length;
+    bool freeBefore = offset > 0 && wordFree(offset - 1);
+    bool freeAfter = end < memSize && wordFree(end);
+    markWords(offset, length, used);
+    if (used) { engineHoles = engineHoles + freeBefore + freeAfter - 1; }
+    else { engineHoles = engineHoles + 1 - freeBefore - freeAfter; }
+}
+
+// Rebuilds holes and the cached hole list from the bitmap after an engine other than HoleList has changed it.
+// Adjacent free blocks are reported as one hole, just as the HoleList engine would have coalesced them.
+void MemoryManager::refreshHoles() {
+    if (!holesStale) { return; }
+    holes.clear();
+    for (unsigned start = findBit(0, false); start < memSize;) {
+        unsigned end = findBit(start, true);
+        holes.push_back(make_pair(start, end - start));
+        start = findBit(end, false);
+    }
+    syncHoleList();
+    holesStale = false;
+}
+
+// --------------Hole bookkeeping-------------- //
+
+// Finds the word offset to allocate from, either from the size index, the bitmap, or by handing the cached holes
+// array (no copy needed) to the allocator function. The offset returned is aligned; built-in policies account for
+// the padding when judging whether a hole fits. Returns -1 if no hole can fit the allocation.
+int MemoryManager::selectHole(unsigned sizeInWords, size_t alignment) {
+    int holeSelected;
+    switch (policy) {
+        case FitPolicy::BestFit:
+        case FitPolicy::WorstFit:
+            return findIndexedHole(sizeInWords, alignment);
+        case FitPolicy::FirstFit:
+            return findFreeRun(sizeInWords, 0, memSize, alignment);
+        case FitPolicy::NextFit: // Search from the cursor to the end, then wrap around
+            holeSelected = findFreeRun(sizeInWords, nextFitCursor, memSize, alignment);
+            if (holeSelected == -1) { holeSelected = findFreeRun(sizeInWords, 0, nextFitCursor, alignment); }
+            if (holeSelected != -1) { nextFitCursor = (holeSelected + sizeInWords) % memSize; }
+            return holeSelected;
+        default: { // Ask for enough extra words that the block fits wherever the chosen hole starts
+            unsigned padding = maxAlignPadding(alignment);
+            if (padding == UINT_MAX || (size_t)sizeInWords + padding > memSize) { return -1; }
+            bool sampling = latencySampling.load(memory_order_relaxed);
+            uint64_t startTicks = sampling ? readTicks() : 0;
+            holeSelected = allocator(sizeInWords + padding, holeListData());
+            if (sampling) { countLatency(counters.allocatorTicks, startTicks); }
+            if (holeSelected == -1) { return -1; }
+            unsigned offset = alignOffset(holeSelected, alignment);
+            return (offset == UINT_MAX) ? -1 : offset;
+        }
+    }
+}
+
+// Returns the first word offset at or after offset whose address is a multiple of alignment, or UINT_MAX.
+unsigned MemoryManager::alignOffset(unsigned offset, size_t alignment) {
+    if (alignment == 1) { return offset; }
+    uintptr_t address = (uintptr_t)memory + (size_t)offset*wordSize;
+    size_t padding = (alignment - address % alignment) % alignment;
+    if (padding % wordSize == 0) { return offset + padding/wordSize; } // Always the case for power-of-two word sizes
+
+    // Otherwise step a word at a time; misalignment repeats after period words, so give up after that
+    size_t period = alignment / gcd((size_t)wordSize, alignment);
+    for (size_t i = 1; i < period; i++) {
+        if ((address + i*wordSize) % alignment == 0) { return offset + i; }
+    }
+    return UINT_MAX;
+}
+
+// Returns the most padding words alignOffset() can ever add for alignment.
+unsigned MemoryManager::maxAlignPadding(size_t alignment) {
+    if (alignOffset(0, alignment) == UINT_MAX) { return UINT_MAX; } // No word can ever be aligned
+    return alignment / gcd((size_t)wordSize, alignment) - 1;
+}
+
+// Turns sizeInWords words at offset into a partition, splitting the hole they come from. The words may start
+// anywhere inside the hole; returns false if they are not all free.
+bool MemoryManager::claim(unsigned offset, unsigned sizeInWords) {
+    unsigned start = removeHoleWords(offset, sizeInWords);
+    if (start == UINT_MAX) { return false; }
+
+    // Keep track of memory partitions
+    partitions[offset] = sizeInWords;
+
+    // Fill bitmap with ones where words were allocated
+    markWords(offset, sizeInWords, true);
+    useWords(sizeInWords);
+    lastHole = start;
+    return true;
+}
+
+// Cached hole list edits, shared by the 16 and 32-bit layouts. Entry 0 is the hole count, then (offset, length) pairs.
+template <typename T>
+static void setListEntry(vector<T>& list, unsigned index, unsigned offset, unsigned length) {
+    list[(index*2)+1] = offset;
+    list[(index*2)+2] = length;
+}
+
+template <typename T>
+static void insertListEntry(vector<T>& list, unsigned index, unsigned offset, unsigned length) {
+    T entry[2] = {(T)offset, (T)length};
+    list.insert(list.begin() + (index*2) + 1, entry, entry + 2);
+    list[0]++;
+}
+
+template <typename T>
+static void eraseListEntry(vector<T>& list, unsigned index) {
+    auto entry = list.begin() + (index*2) + 1;
+    list.erase(entry, entry + 2);
+    list[0]--;
+}
+
+template <typename T>
+static void syncList(vector<T>& list, const vector<pair<unsigned, unsigned>>& holes) {
+    list.resize((holes.size()*2) + 1);
+    list[0] = holes.size();
+    for (unsigned i = 0; i < holes.size(); i++) {
+        setListEntry(list, i, holes[i].first, holes[i].second);
+    }
+}
+
+// Updates a hole in place and mirrors the change into the cached hole list.
+void MemoryManager::setHole(unsigned index, unsigned offset, unsigned length) {
+    if (sizeIndexed) {
+        holesBySize.erase(make_pair(holes[index].second, holes[index].first));
+        holesBySize.insert(make_pair(length, offset));
+    }
+    holes[index] = make_pair(offset, length);
+    if (offsetWidth == OffsetWidth::Bits32) { setListEntry(wideHoleList, index, offset, length); }
+    else { setListEntry(holeList, index, offset, length); }
+}
+
+// Adds a hole before index (keeping holes sorted) and opens a gap for it in the cached hole list.
+void MemoryManager::insertHole(unsigned index, unsigned offset, unsigned length) {
+    if (sizeIndexed) { holesBySize.insert(make_pair(length, offset)); }
+    holes.insert(holes.begin() + index, make_pair(offset, length));
+    if (offsetWidth == OffsetWidth::Bits32) { insertListEntry(wideHoleList, index, offset, length); }
+    else { insertListEntry(holeList, index, offset, length); }
+}
+
+// Takes a run of free words out of the hole holding it and returns that hole's start, or UINT_MAX if the words are not
+// all in one hole. Whatever is left on either side stays a hole.
+unsigned MemoryManager::removeHoleWords(unsigned offset, unsigned length) {
+    // Find the hole containing offset (holes are kept sorted by offset)
+    auto hole = upper_bound(holes.begin(), holes.end(), make_pair(offset, UINT_MAX));
+    if (hole == holes.begin()) { return UINT_MAX; }
+    unsigned index = --hole - holes.begin();
+    unsigned start = hole->first, end = hole->first + hole->second;
+    if (offset + length > end) { return UINT_MAX; }
+
+    unsigned front = offset - start, back = end - (offset + length);
+    if (front == 0 && back == 0) { eraseHole(index); } // Run fits perfectly in hole
+    else if (front == 0) { setHole(index, offset + length, back); }
+    else {
+        setHole(index, start, front);
+        if (back != 0) { insertHole(index + 1, offset + length, back); }
+    }
+    return start;
+}
+
+// Adds a run of words to holes. Holes are kept sorted by offset, so the only merge candidates are the holes on either
+// side of it.
+void MemoryManager::addHoleWords(unsigned offset, unsigned length) {
+    unsigned index = lower_bound(holes.begin(), holes.end(), make_pair(offset, 0u)) - holes.begin();
+    bool mergePrevious = index > 0 && holes[index-1].first + holes[index-1].second == offset;
+    bool mergeNext = index < holes.size() && holes[index].first == offset + length;
+
+    if (mergePrevious && mergeNext) { // Run bridges two holes
+        setHole(index-1, holes[index-1].first, holes[index-1].second + length + holes[index].second);
+        eraseHole(index);
+    }
+    else if (mergePrevious) { // Extend the hole that ends right before the run
+        setHole(index-1, holes[index-1].first, holes[index-1].second + length);
+    }
+    else if (mergeNext) { // Pull the hole right after the run back over it
+        setHole(index, offset, length + holes[index].second);
+    }
+    else { // Otherwise the run becomes a new hole in place
+        insertHole(index, offset, length);
+    }
+}
+
+// Removes a hole and shifts the cached hole list down over it, no reallocation needed.
+void MemoryManager::eraseHole(unsigned index) {
+    if (sizeIndexed) { holesBySize.erase(make_pair(holes[index].second, holes[index].first)); }
+    holes.erase(holes.begin() + index);
+    if (offsetWidth == OffsetWidth::Bits32) { eraseListEntry(wideHoleList, index); }
+    else { eraseListEntry(holeList, index); }
+}
+
+// Rewrites the cached hole list from holes. The buffer keeps its capacity, so this never touches the heap once
+// the list has reached its largest size.
+void MemoryManager::syncHoleList() {
+    if (offsetWidth == OffsetWidth::Bits32) { syncList(wideHoleList, holes); }
+    else { syncList(holeList, holes); }
+}
+
+// Returns the cached hole list in whichever layout the offset width calls for.
+void* MemoryManager::holeListData() {
+    if (offsetWidth == OffsetWidth::Bits32) { return wideHoleList.data(); }
+    return holeList.data();
+}
+
+// Rebuilds the size index from holes, or clears it when the allocator is not bestFit or worstFit.
+void MemoryManager::syncHoleIndex() {
+    holesBySize.clear();
+    if (!sizeIndexed) { return; }
+    for (auto& hole : holes) {
+        holesBySize.insert(make_pair(hole.second, hole.first));
+    }
+}
+
+// Answers bestFit/worstFit from the size index. Ties go to the lowest offset, exactly like the list-scanning versions.
+// Aligned requests may have to look past holes that are only big enough before padding.
+int MemoryManager::findIndexedHole(unsigned sizeInWords, size_t alignment) {
+    if (holesBySize.empty() || holesBySize.rbegin()->first < sizeInWords) { return -1; }
+
+    if (alignment == 1) { // Smallest hole that fits, or the first hole of the largest size
+        unsigned length = (policy == FitPolicy::BestFit) ? sizeInWords : holesBySize.rbegin()->first;
+        return holesBySize.lower_bound(make_pair(length, 0u))->second;
+    }
+
+    // Walk holes from the preferred end of the size order, one size at a time so ties still go to the lowest offset
+    auto fits = [&](const pair<unsigned, unsigned>& hole) {
+        unsigned offset = alignOffset(hole.second, alignment);
+        return offset != UINT_MAX && (size_t)offset + sizeInWords <= (size_t)hole.second + hole.first;
+    };
+    if (policy == FitPolicy::BestFit) {
+        for (auto hole = holesBySize.lower_bound(make_pair(sizeInWords, 0u)); hole != holesBySize.end(); ++hole) {
+            if (fits(*hole)) { return alignOffset(hole->second, alignment); }
+        }
+        return -1;
+    }
+    for (auto end = holesBySize.end(); end != holesBySize.begin();) {
+        auto start = holesBySize.lower_bound(make_pair(prev(end)->first, 0u));
+        if (start->first < sizeInWords) { break; }
+        for (auto hole = start; hole != end; ++hole) {
+            if (fits(*hole)) { return alignOffset(hole->second, alignment); }
+        }
+        end = start;
+    }
+    return -1;
+}
+
+// --------------Bitmap bookkeeping-------------- //
+
+// Sets (used) or clears (free) the bitmap bits of a run of words. On a persistent arena the change is logged too, for
+// the other attached managers to replay; this manager is current with it already.
+void MemoryManager::markWords(unsigned offset, unsigned length, bool used) {
+    markBitmapWords(bitmap, offset, length, used);
+    if (shared == nullptr) { return; }
+    shared->changes[shared->generation % sharedLogLength] = {offset, length, used};
+    sharedGeneration = ++shared->generation;
+}
+
+// Returns the first word at or after from whose bit is used (1) or free (0), or memSize if there is none.
+unsigned MemoryManager::findBit(unsigned from, bool used) {
+    return findBitmapBit(bitmap, memSize, from, used);
+}
+
+// Returns the offset of the first run of sizeInWords free words at an aligned offset in [from, to), or -1.
+int MemoryManager::findFreeRun(unsigned sizeInWords, unsigned from, unsigned to, size_t alignment) {
+    unsigned start = findBit(from, false);
+    while (start < to) {
+        unsigned end = findBit(start, true);
+        unsigned offset = alignOffset(start, alignment);
+        if (offset != UINT_MAX && offset < to && (size_t)offset + sizeInWords <= end) { return offset; }
+        start = findBit(end, false);
+    }
+    return -1;
 }
 
 // --------------Memory allocation algorithms-------------- //
@@ -257,4 +2098,22 @@ int worstFit(int sizeInWords, void* list) {
         }
     }
     return worstFitHole[0];
+}
+
+// Find first hole in offset order that can fit partition being allocated
+int firstFit(int sizeInWords, void* list) {
+    uint16_t* holes = (uint16_t*)list;
+    uint16_t holeListlength = *holes;
+
+    for (int i = 1; i < (holeListlength * 2); i += 2) {
+        if (holes[i+1] >= sizeInWords) { return holes[i]; }
+    }
+    return -1;
+}
+
+// Find first hole that can fit partition being allocated, starting where the previous search left off. The cursor
+// belongs to the memory manager, which recognizes this function and searches from its own; called directly there is
+// no previous search to go on, so the search starts at the first hole.
+int nextFit(int sizeInWords, void* list) {
+    return firstFit(sizeInWords, list);
 }
\ No newline at end of file
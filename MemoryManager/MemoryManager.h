@@ -1,40 +1,356 @@
+#pragma once
+
 #include <iostream>
 #include <vector>
+#include <set>
+#include <map>
+#include <unordered_map>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <atomic>
 #include <algorithm>
 #include <fstream>
 #include <string>
 #include <cmath>
+#include <chrono>
 #include <unistd.h>
 #include <cstring>
+#include <climits>
 #include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "TraceRecorder.h"
+#include "WordBitmap.h"
 
 using namespace std;
 
+// Built-in allocator functions over the Bits16 hole list. The memory manager recognizes them and serves them natively;
+// nextFit keeps its cursor in each memory manager, so it holds no state of its own.
 int bestFit(int sizeInWords, void* list);
 int worstFit(int sizeInWords, void* list);
+int firstFit(int sizeInWords, void* list);
+int nextFit(int sizeInWords, void* list);
+
+// Fit policies the memory manager recognizes and serves from its own structures instead of calling back through the
+// hole list: bestFit/worstFit from a size-ordered hole index, firstFit/nextFit from the bitmap. Any other allocator
+// function is Custom.
+enum class FitPolicy { Custom, BestFit, WorstFit, FirstFit, NextFit };
+
+// Width of the offsets, lengths and sizes in getList() and getBitmap(). Bits16 is the compact format and caps the
+// arena at 65535 words. Bits32 widens the hole list to uint32_t entries and the bitmap size header to four bytes,
+// allowing arenas up to INT_MAX words (the largest offset an allocator function can return).
+enum class OffsetWidth { Bits16, Bits32 };
+
+// Allocation engines. HoleList carves requests out of the offset-ordered hole list using the allocator function.
+// Buddy is a binary buddy system: requests are rounded up to a power of two words and served from per-order free
+// lists, splitting and merging buddies in O(log N), so it ignores the allocator function. TLSF (two-level segregated
+// fit) bins free blocks by size class and finds one that fits with two bitmap searches, then splits off the words
+// asked for, so allocate() and free() take O(1) however fragmented the arena is; it ignores the allocator function
+// too. Both engines keep their bookkeeping in tags inside the free blocks, so they need no memory per word beyond the
+// partition table, and round blocks up to a minimum that fits a tag: 16 bytes for TLSF, 12 bytes rounded up to a power
+// of two words for Buddy. getList(), getBitmap() and dumpMemoryMap() report the free words the same way for every
+// engine.
+enum class Engine { HoleList, Buddy, TLSF };
+
+// Huge page use for a mapped arena. Transparent asks the kernel to back it with transparent huge pages through
+// madvise(MADV_HUGEPAGE). Explicit maps it from the reserved hugetlb pool with MAP_HUGETLB, falling back to
+// Transparent when no huge pages are reserved.
+enum class HugePages { None, Transparent, Explicit };
+
+// Where initialize() gets the arena from. By default it comes from the heap and is zero-filled up front. A mapped
+// arena comes from an anonymous mmap instead, which the kernel zeroes lazily as pages are first touched, and so do its
+// partition table and bitmap, so startup does not scale with the arena size. Huge pages and NUMA binding only apply to
+// a mapped arena, so asking for either maps it too. NUMA binding is best effort: if the kernel refuses it, the arena is
+// simply left unbound.
+struct ArenaOptions {
+    bool mapped = false;
+    HugePages hugePages = HugePages::None;
+    int numaNode = -1; // NUMA node to bind the arena's pages to with mbind, or -1 for the default policy
+};
+
+// Formats dumpMemoryMap() can write. Text is the human-readable hole list. Binary is a little-endian uint32_t hole
+// count followed by (offset, length) uint32_t pairs. Incremental appends a record of what changed since the previous
+// dump: the holes that are gone, then the holes that are new, each in the Binary layout. Replaying the records in
+// order on top of the dump before the first one gives the hole list at every dump.
+enum class DumpFormat { Text, Binary, Incremental };
+
+// Snapshot returned by MemoryManager::getStats(). Sizes are in bytes; blocks parked in thread caches in concurrent
+// mode count as in use, as they do in getList(). Everything starts over at initialize() or attach().
+struct MemoryStats {
+    static constexpr unsigned sizeClassCount = 32;
+    static constexpr unsigned latencyBucketCount = 32;
+
+    uint64_t allocations; // Blocks handed out, counting each block of allocateMany() and each reallocate() that moved
+    uint64_t frees;
+    uint64_t failures; // Valid allocation requests that returned nullptr because no hole could fit them
+    size_t bytesInUse;
+    size_t peakBytesInUse;
+    size_t largestHole; // With the Buddy engine, the largest free block: neighbours that are not buddies never merge
+    size_t holeCount;
+    double fragmentation; // 1 - largestHole / free bytes: 0 while free memory is one hole, nearing 1 as it splinters
+    uint64_t sizeClasses[sizeClassCount]; // Allocations by requested size, class k is (2^(k-1), 2^k] bytes
+
+    // Latency histograms, only filled while latency sampling is on. Bucket k counts calls that took [2^k, 2^(k+1))
+    // ticks of the time-stamp counter (nanoseconds on machines without one).
+    uint64_t allocateTicks[latencyBucketCount]; // Whole allocate() and allocateAligned() calls
+    uint64_t freeTicks[latencyBucketCount]; // Whole free() calls
+    uint64_t allocatorTicks[latencyBucketCount]; // Just the allocator function, for allocators that are not built in
+};
+
+// Event counters behind MemoryStats. Each set has one writer at a time, the thread owning it or whoever holds the
+// central lock, so updates are relaxed loads and stores rather than read-modify-write atomics and cost about as much
+// as plain increments.
+struct StatCounters {
+    atomic<uint64_t> allocations{0};
+    atomic<uint64_t> frees{0};
+    atomic<uint64_t> failures{0};
+    atomic<uint64_t> sizeClasses[MemoryStats::sizeClassCount] = {};
+    atomic<uint64_t> allocateTicks[MemoryStats::latencyBucketCount] = {};
+    atomic<uint64_t> freeTicks[MemoryStats::latencyBucketCount] = {};
+    atomic<uint64_t> allocatorTicks[MemoryStats::latencyBucketCount] = {};
+
+    // Adds amount to a counter; only safe for its single writer.
+    static void add(atomic<uint64_t>& counter, uint64_t amount) {
+        counter.store(counter.load(memory_order_relaxed) + amount, memory_order_relaxed);
+    }
+    void reset();
+    // Adds every counter of other into this set; only safe for the single writer of this set.
+    void merge(const StatCounters& other);
+};
+
+// Relocatable block returned by MemoryManager::allocateHandle(). 0 is never a valid handle.
+using Handle = uint32_t;
+
+// Per-thread block cache used in concurrent mode, see MemoryManager::setConcurrent().
+struct ThreadCache;
+
+// Header at the start of a persistent arena's file, and the lock that guards it; see MemoryManager::attach().
+struct SharedHeader;
+class SharedGuard;
 
 class MemoryManager {
-    private:
-        vector<char> memory;
+    protected: // Open to BasicMemoryManager, which inlines its fit policy over these structures
+        char* memory; // Arena, aligned to arenaAlignment
+        size_t memoryBytes;
+        size_t mappedBytes; // Length of the mapping behind memory, or 0 if it came from the heap
         vector<pair<unsigned, unsigned>> holes;
-        vector<pair<unsigned, unsigned>> partitions;
-        vector<int> bitmap;
+        unsigned* partitions; // Length in words of the partition starting at each word offset, 0 if none
+        vector<unsigned> partitionStore; // Backs partitions of a heap arena
+        uint64_t* bitmap; // One bit per word, word i is bit (i % 64) of bitmap[i / 64]
+        vector<uint64_t> bitmapStore; // Backs bitmap unless it lives in metadata
+        char* metadata; // Lazily zeroed mapping behind partitions and bitmap of a mapped arena, or nullptr
+        size_t metadataBytes;
+        vector<uint16_t> holeList; // getList() layout of holes, kept in sync so allocate() can hand it out directly
+        vector<uint32_t> wideHoleList; // Same as holeList, used instead of it for Bits32 offsets
+        vector<pair<unsigned, unsigned>> dumpSnapshot; // Holes at the last dumpMemoryMap(), for Incremental dumps
+        OffsetWidth offsetWidth;
         unsigned wordSize;
         size_t memSize;
         function<int(int, void*)> allocator;
+        FitPolicy policy;
+        bool sizeIndexed; // Whether holesBySize is being maintained (bestFit and worstFit only)
+        set<pair<unsigned, unsigned>> holesBySize; // (length, offset) of every hole
+        unsigned nextFitCursor; // Word just past the last next-fit allocation
+
+        // Engines other than HoleList keep their own free structures and rebuild holes from the bitmap on demand
+        Engine engine;
+        bool holesStale;
+        void refreshHoles();
+        size_t engineHoles; // Holes formed by the engine's free blocks, kept current for getStats()
+        // Marks the words of a block that is handed out or freed like markWords(), counting holes split or merged.
+        void markEngineWords(unsigned offset, unsigned length, bool used);
+
+        // Free block tags - the first bytes of every Buddy or TLSF free block hold its previous and next free block
+        // and its size (order for Buddy, words for TLSF); a TLSF free block also ends with its start. Blocks are never
+        // shorter than minBlockWords, so the tags always fit.
+        static constexpr unsigned tagPrevious = 0, tagNext = 1, tagSize = 2;
+        static constexpr unsigned tagBytes = 3*sizeof(uint32_t);
+        unsigned minBlockWords;
+        uint32_t readTag(unsigned offset, unsigned field);
+        void writeTag(unsigned offset, unsigned field, uint32_t value);
+        unsigned readTail(unsigned end);
+        void writeTail(unsigned offset, unsigned length);
+        bool wordFree(unsigned offset);
+        void initializeEngine();
+
+        // Buddy engine - free blocks of each order are doubly linked through their tags
+        unsigned freeHeads[32]; // First free block of each order, or UINT_MAX
+        uint32_t nonEmptyOrders; // Bit k set if freeHeads[k] is not empty
+        unsigned buddyBlockOrder(unsigned offset, unsigned end);
+        void buddyInitialize();
+        void* buddyAllocate(unsigned sizeInWords, size_t alignment);
+        void buddyFree(unsigned wordOffset, unsigned length);
+        void pushFreeBlock(unsigned order, unsigned offset);
+        void removeFreeBlock(unsigned order, unsigned offset);
+
+        // TLSF engine - free blocks are binned into tlsfFirstLevels power-of-two size ranges, each split into
+        // tlsfSecondLevels linear classes, and doubly linked through their tags like buddies. The tags at both ends of
+        // every free block let free() find and merge either neighbour in O(1).
+        static constexpr unsigned tlsfSecondLevelBits = 4;
+        static constexpr unsigned tlsfSecondLevels = 1 << tlsfSecondLevelBits;
+        static constexpr unsigned tlsfFirstLevels = 32 - tlsfSecondLevelBits;
+        unsigned tlsfHeads[tlsfFirstLevels][tlsfSecondLevels]; // First free block of each class, or UINT_MAX
+        uint32_t firstLevelMap; // Bit f set if any class of first level f is not empty
+        uint32_t secondLevelMaps[tlsfFirstLevels]; // Bit s of entry f set if class (f, s) is not empty
+        void tlsfInitialize();
+        void* tlsfAllocate(unsigned sizeInWords, size_t alignment);
+        unsigned findTlsfBlock(size_t needed);
+        void tlsfFree(unsigned wordOffset, unsigned length);
+        bool tlsfResize(unsigned wordOffset, unsigned sizeInWords);
+        void insertTlsfBlock(unsigned offset, unsigned length);
+        void removeTlsfBlock(unsigned offset);
+        static void tlsfClass(unsigned length, unsigned& firstLevel, unsigned& secondLevel);
+        unsigned largestTlsfBlock();
+
+        // Concurrent mode - the central lock guards everything above; small blocks are served from per-thread caches
+        bool concurrent;
+        mutex centralLock;
+        uint64_t id; // Unique for the life of the process, lets threads find their cache for this manager
+        vector<unique_ptr<ThreadCache>> threadCaches;
+        friend struct ThreadCacheHandle;
+
+        unique_lock<mutex> lockCentral();
+        ThreadCache* threadCache();
+        void* cachedAllocate(unsigned sizeInWords);
+        void cachedFree(unsigned wordOffset, unsigned length);
+        void flushThreadCache(ThreadCache* cache);
+        void retireThreadCache(ThreadCache* cache);
+
+        // Persistent arena - the arena, partitions, the engine's free lists and a log of recent changes live in a
+        // shared file mapping; holes and bitmap replay the changes other managers have logged since the last call
+        SharedHeader* shared; // Start of the mapping, or nullptr for a private arena
+        size_t sharedBytes;
+        uint64_t sharedGeneration; // Count of logged changes that holes and bitmap are current with
+        friend class SharedGuard;
+        friend struct SharedHeader;
+        void rebuildFromPartitions();
+        void resetShared();
+        void syncShared();
+        void applyChange(unsigned offset, unsigned length, bool used);
+        void loadEngine();
+        void publishEngine();
+
+        // Statistics - words in use change only under the central lock; event counters go to the calling thread's
+        // cache in concurrent mode so the thread-cached fast path never shares a cache line with other threads
+        size_t wordsInUse;
+        size_t peakWordsInUse;
+        StatCounters counters;
+        atomic<bool> latencySampling; // May be switched while other threads allocate, so loads are relaxed
+        StatCounters& statCounters();
+        void countAllocations(StatCounters& target, size_t sizeInBytes, uint64_t blocks, bool failed);
+        void countLatency(atomic<uint64_t>* histogram, uint64_t startTicks);
+        void useWords(size_t words);
+
+        // Deferred free - freed partitions wait in quick lists by length, still marked allocated, until they are
+        // reused by an allocation of the same length or merged into holes in one pass
+        bool deferFrees;
+        unordered_map<unsigned, vector<unsigned>> quickLists; // Word offsets of deferred partitions, by length
+        size_t deferredCount;
+        void deferWords(unsigned wordOffset, unsigned length);
+        void flushDeferred();
+        // Merges runs, already cleared from partitions and bitmap, into holes in a single sort-merge pass.
+        void mergeRuns(vector<pair<unsigned, unsigned>>& runs);
+
+        // Handles - partitions that compact() may slide towards the start of the arena while they are not pinned
+        struct HandleEntry {
+            unsigned wordOffset;
+            unsigned pins; // Outstanding pin() calls, the partition does not move while this is not 0
+            bool live;
+        };
+        vector<HandleEntry> handles; // Entry of handle h is handles[h - 1]
+        vector<Handle> freeHandles; // Freed handles, reused before the table grows
+        map<unsigned, Handle> relocatable; // Handle of each handle partition, by word offset
+        unsigned compactCursor; // Word offset the next compact() step resumes from
+        HandleEntry* handleEntry(Handle handle);
+        void slidePartition(unsigned index, Handle handle);
+
+        // Trace recording - events go to the recorder's lock-free ring while a trace is running
+        unique_ptr<TraceRecorder> tracer;
+        unsigned lastHole; // Start of the hole the last claim() carved from, for trace records
+        void traceEvent(TraceEvent event, uint64_t size, void* address, uint32_t hole);
+
+        // Maps memoryBytes of arena as options ask, returning false if no mapping could be made.
+        bool mapArena(const ArenaOptions& options);
+        bool mapMetadata();
+
+        // Unlocked bodies of the public functions of the same name. freeWords() takes the partition's length from the
+        // caller, which has looked it up or been given it by a sized free.
+        void release();
+        void* allocateWords(unsigned sizeInWords, size_t alignment);
+        size_t carveWords(size_t count, unsigned words, void** out, size_t traceBytes);
+        void freeWords(unsigned wordOffset, unsigned length);
+        // Resizes the partition at wordOffset without moving it, or returns false and leaves it alone.
+        bool resizeWords(unsigned wordOffset, unsigned sizeInWords);
+        bool buddyResize(unsigned wordOffset, unsigned sizeInWords);
+        // Frees the live partition of length words at wordOffset, once free() has found or been told its length.
+        void freeBlock(void* address, unsigned wordOffset, unsigned length);
+
+        // Allocation steps - pick a word offset for the request, then carve it out of its hole.
+        int selectHole(unsigned sizeInWords, size_t alignment);
+        bool claim(unsigned offset, unsigned sizeInWords);
+        // Returns the first word offset at or after offset whose address is a multiple of alignment, or UINT_MAX.
+        unsigned alignOffset(unsigned offset, size_t alignment);
+        // Returns the most padding words alignOffset() can ever add for alignment.
+        unsigned maxAlignPadding(size_t alignment);
+
+        // Hole bookkeeping - changes to holes go through these so the cached hole list never goes stale.
+        void setHole(unsigned index, unsigned offset, unsigned length);
+        void insertHole(unsigned index, unsigned offset, unsigned length);
+        void eraseHole(unsigned index);
+        // Takes a run of free words out of the hole holding it and returns that hole's start, or UINT_MAX if the
+        // words are not all in one hole.
+        unsigned removeHoleWords(unsigned offset, unsigned length);
+        // Adds a run of words to holes, merging it with the holes on either side.
+        void addHoleWords(unsigned offset, unsigned length);
+        void syncHoleList();
+        void* holeListData();
+        void syncHoleIndex();
+        int findIndexedHole(unsigned sizeInWords, size_t alignment);
+
+        // Size of the getBitmap() output in bytes, and the unlocked body that writes it.
+        size_t bitmapBytes();
+        void writeBitmap(uint8_t* bits);
+
+        // Sets (used) or clears (free) the bitmap bits of a run of words, logging the change on a persistent arena.
+        void markWords(unsigned offset, unsigned length, bool used);
+        // Returns the first word at or after from whose bit is used (1) or free (0), or memSize if there is none.
+        unsigned findBit(unsigned from, bool used);
+        // Returns the offset of the first run of sizeInWords free words at an aligned offset in [from, to), or -1.
+        int findFreeRun(unsigned sizeInWords, unsigned from, unsigned to, size_t alignment);
 
     public:
         // Constructor - Sets native word size (in bytes, for alignment) and default allocator for finding a memory hole.
         MemoryManager(unsigned wordSize, function<int(int, void*)> allocator);
+        // Constructor - Same as above, with the offset width used for getList(), getBitmap() and the allocator function.
+        MemoryManager(unsigned wordSize, function<int(int, void*)> allocator, OffsetWidth offsetWidth);
+        // Constructor - Sets native word size and an allocation engine that picks holes itself, such as Buddy.
+        MemoryManager(unsigned wordSize, Engine engine, OffsetWidth offsetWidth = OffsetWidth::Bits16);
         // Destructor - Releases all memory allocated by this object without leaking memory.
         ~MemoryManager();
 
         // --------------------------------------------Class Functions-------------------------------------------- //
 
-        // Instantiates block of requested size, no larger than 65536 words; cleans up previous block if applicable.
+        // Instantiates block of requested size, no larger than 65535 words (INT_MAX words with Bits32 offsets); cleans
+        // up previous block if applicable.
         void initialize(size_t sizeInWords);
 
+        // Same as above, with the arena mapped, placed on huge pages or bound to a NUMA node as options ask. Falls
+        // back to a heap arena if it cannot be mapped.
+        void initialize(size_t sizeInWords, const ArenaOptions& options);
+
+        // Attaches to the persistent arena in the file at path (a path under /dev/shm gives a shared memory object),
+        // creating it with sizeInWords words if the file does not exist; an existing arena keeps its own size and
+        // every block allocated in it. The arena and its partition table live in the file mapping, so any number of
+        // memory managers, in this or other processes, can attach to it at once and a restarted process picks up
+        // where it left off. Calls are serialized across processes by a lock in the file, which also logs the last
+        // sharedLogLength changes; a manager replays the ones others made since its last call, and only rebuilds its
+        // holes and bitmap from the partition table (O(words)) if it has fallen further behind than that. Concurrent
+        // and deferred free modes are not available on a persistent arena. shutdown() detaches and leaves the file in
+        // place. Returns false if either mode is on, the file cannot be mapped or it holds an
+        // arena of another word size or engine.
+        bool attach(const char* path, size_t sizeInWords);
+
         // Releases memory block acquired during initialization, if any. This should only include memory created for
         // long term use not those that returned such as getList() or getBitmap() as whatever is calling those should
         // delete it instead.
@@ -43,26 +359,123 @@ class MemoryManager {
         // Allocates a memory using the allocator function. If no memory is available or size is invalid, returns nullptr.
         void* allocate(size_t sizeInBytes);
 
-        // Frees the memory block within the memory manager so that it can be reused.
+        // Allocates like allocate(), but the returned address is a multiple of alignment (in bytes, a power of two),
+        // e.g. 64 for cache-line or AVX-512 buffers. Padding skipped in front of the block stays a hole. Returns
+        // nullptr if no hole can fit the block once aligned. The Buddy engine supports alignments up to
+        // arenaAlignment; bigger ones fail.
+        void* allocateAligned(size_t sizeInBytes, size_t alignment);
+
+        // Frees the memory block within the memory manager so that it can be reused. Addresses that were not returned
+        // by allocate() are ignored.
         void free(void* address);
 
-        // Changes the allocation algorithm to identifying the memory hole to use for allocation.
+        // Sized free: like free(), but trusts sizeInBytes to be the size address was allocated with, e.g. when a
+        // container or std::pmr caller knows it. None of the address checks run and the block's length is taken from
+        // sizeInBytes instead of the partition table, except on the Buddy and TLSF engines, which round blocks up when
+        // they hand them out. Only a debug build (NDEBUG not defined) asserts that address starts a live block of that
+        // size; anything else is undefined behaviour in a release build.
+        void free(void* address, size_t sizeInBytes);
+
+        // Resizes the block at address to sizeInBytes and returns its new address, keeping the contents up to the
+        // smaller of the two sizes. Shrinking splits the tail off as a hole and growing extends into the hole right
+        // after the block, so the block only moves (allocate, copy, free) when that hole is too small. A nullptr
+        // address allocates and a size of 0 frees; on failure returns nullptr and the old block is left untouched.
+        void* reallocate(void* address, size_t sizeInBytes);
+
+        // Allocates up to count blocks of sizeInBytes each into out and returns how many it got. A burst is carved
+        // from as few holes as possible, one allocator call and one hole update per hole, instead of count separate
+        // allocate() calls. Blocks always come from the holes, even in concurrent mode.
+        size_t allocateMany(size_t count, size_t sizeInBytes, void** out);
+
+        // Frees count blocks at once. The freed partitions are sorted and merged into holes in a single pass, so a
+        // batch costs one hole list rebuild instead of one per block. Invalid addresses are ignored as by free().
+        void freeMany(void** addresses, size_t count);
+
+        // Switches concurrent mode on or off; must be called while no other thread is using the memory manager. In
+        // concurrent mode every function may be called from any thread. Blocks of up to threadCacheClasses words are
+        // freed into a cache owned by the calling thread and reused by its next allocation of the same size; only
+        // refilling a cache, flushing a full one, and larger blocks take the central lock. Cached blocks still count
+        // as allocated in getList(), getBitmap() and dumpMemoryMap(). A thread's cache is flushed and dropped when the
+        // thread exits (its counts stay in getStats()), and discarded by initialize() and shutdown(), which must not
+        // race with other threads. The lock is one for the whole arena rather than one per size class, as every class
+        // carves from the same holes and bitmap; a refill carves its whole batch in one pass to hold it briefly.
+        void setConcurrent(bool concurrent);
+
+        // Switches deferred free mode on or off; must be called while no other thread is using the memory manager.
+        // In deferred mode a freed block is not coalesced: it goes onto a quick list for its length and the next
+        // allocation of that many words takes it back in O(1). Queued blocks are merged into the holes in a single
+        // sort-merge pass once deferredFreeLimit of them are waiting, when an allocation finds no hole, on
+        // flushDeferredFrees(), and when the mode is switched off. Like cached blocks, queued blocks still count as
+        // allocated in getList(), getBitmap(), dumpMemoryMap() and getStats(). Only the HoleList engine defers frees,
+        // and it is not available on a persistent arena.
+        void setDeferredFree(bool deferred);
+
+        // Merges every block queued by deferred free mode into the holes.
+        void flushDeferredFrees();
+
+        // Blocks queued in deferred free mode before they are merged into the holes.
+        static constexpr unsigned deferredFreeLimit = 256;
+
+        // Alignment of the start of the arena in bytes (one page), so allocateAligned() can honour any alignment up to
+        // it without depending on where the arena landed.
+        static constexpr size_t arenaAlignment = 4096;
+
+        // Largest block, in words, served from a thread cache, blocks cached per size class before half are flushed,
+        // and blocks fetched from the central holes in one refill.
+        static constexpr unsigned threadCacheClasses = 32;
+        static constexpr unsigned threadCacheDepth = 64;
+        static constexpr unsigned threadCacheRefill = 8;
+
+        // Changes the allocation algorithm to identifying the memory hole to use for allocation; only the HoleList
+        // engine uses it. bestFit and worstFit
+        // are recognized and answered from a size-ordered hole index in O(log n) rather than a scan of the hole list;
+        // firstFit and nextFit are answered by scanning the bitmap 64 words at a time.
         void setAllocator(std::function<int(int, void*)> allocator);
 
         // Uses standard POSIX calls to write hole list to filename as text, returning -1 on error and 0 if successful.
         // Format: "[START, LENGTH] - [START, LENGTH] …", e.g., "[0, 10] - [12, 2] - [20, 6]".
         int dumpMemoryMap(char* filename);
 
+        // Same as above in the given format. The dump is built in memory and written with a single write(), replacing
+        // the file, except that Incremental dumps are appended to it.
+        int dumpMemoryMap(char* filename, DumpFormat format);
+
         // Returns an array of information (in decimal) about holes for use by the allocator function (little-Endian).
         // Offset and length are in words. If no memory has been allocated, the function should return a NULL pointer.
         // Format: [(# holes), (hole 0 offset), (hole 0 length), (hole 1 offset), (hole 1 length), ...] 
         // Example: [3, 0, 10, 12, 2, 20, 6]
+        // Entries are uint16_t, or uint32_t with Bits32 offsets.
         void* getList();
-        
+
+        // Returns a read-only view of the same hole list without copying it; this is what allocate() passes to the
+        // allocator function. The view is owned by the memory manager and is only valid until the next allocate(),
+        // free(), initialize() or shutdown() call, so it is not safe to use in concurrent mode. If no memory has been
+        // allocated, returns a NULL pointer.
+        const void* getListView();
+
         // Returns a bit-stream of bits in terms of an array representing whether words are used (1) or free (0). The
-        // first two bytes are the size of the bitmap (little-Endian); the rest is the bitmap, word-wise.
+        // first two bytes are the size of the bitmap (little-Endian); the rest is the bitmap, word-wise. With Bits32
+        // offsets the size takes the first four bytes instead.
         void* getBitmap();
 
+        // Returns the bytes getList(buffer, bufferBytes) would write right now, or 0 if no memory has been allocated.
+        // The list grows and shrinks with the number of holes, so this is only exact until the next allocate() or
+        // free(); 2 + (arena size in words) entries are always enough.
+        size_t getListBytes();
+
+        // Writes the same hole list as getList() into a caller-owned buffer instead of a new one, so a monitor can
+        // poll it without touching the heap. Returns the bytes written, or 0 if no memory has been allocated or the
+        // list does not fit in bufferBytes (query getListBytes() and try again).
+        size_t getList(void* buffer, size_t bufferBytes);
+
+        // Returns the bytes getBitmap(buffer, bufferBytes) writes, or 0 if no memory has been allocated. The size only
+        // changes with initialize().
+        size_t getBitmapBytes();
+
+        // Writes the same bitmap as getBitmap() into a caller-owned buffer instead of a new one. Returns the bytes
+        // written, or 0 if no memory has been allocated or the bitmap does not fit in bufferBytes.
+        size_t getBitmap(void* buffer, size_t bufferBytes);
+
         // Returns the word size used for alignment.
         unsigned getWordSize();
 
@@ -70,5 +483,51 @@ class MemoryManager {
         void* getMemoryStart();
 
         // Returns the byte limit of the current memory block.
-        unsigned getMemoryLimit();
+        size_t getMemoryLimit();
+
+        // Returns allocation counters, bytes in use, hole and fragmentation figures in one snapshot, without building a
+        // hole list.
+        MemoryStats getStats();
+
+        // Switches the latency histograms of getStats() on or off. Sampling reads the time-stamp counter twice per
+        // call, so it is off by default. Safe to call while other threads use the memory manager; calls already under
+        // way keep the setting they started with.
+        void setLatencySampling(bool sampling);
+
+        // Starts recording every allocation, free and setAllocator() call to filename in the TraceRecorder format,
+        // replacing any trace already running. Records are buffered in a lock-free ring and written by a background
+        // thread. Batch calls are recorded block by block, and a reallocate() as a free of the old block followed by
+        // an allocation of the new size. Must not race with other calls. Returns false if the file cannot be created.
+        bool startTrace(const char* filename);
+
+        // Stops the running trace once every buffered record has been written, and returns how many records were
+        // dropped because the ring was full. Must not race with other calls.
+        uint64_t stopTrace();
+
+        // Allocates like allocate(), but returns a handle instead of an address so that compact() can move the block
+        // while it is not pinned. Returns 0 if no hole can fit the block. A handle's block must only be freed with
+        // freeHandle(), never passed to free() or reallocate().
+        Handle allocateHandle(size_t sizeInBytes);
+
+        // Returns the current address of handle's block and keeps the block from moving until the matching unpin().
+        // Pins nest, and the address is only stable while pinned. Returns nullptr for an invalid handle.
+        void* pin(Handle handle);
+
+        // Releases one pin() of handle, letting compact() move its block once no pins are left.
+        void unpin(Handle handle);
+
+        // Frees handle's block, pinned or not. The handle becomes invalid and may be handed out again by a later
+        // allocateHandle().
+        void freeHandle(Handle handle);
+
+        // Runs an incremental compaction pass for about budget: unpinned handle blocks slide down into the hole right
+        // before them, one at a time, so free space collects into fewer, larger holes. Blocks from allocate() and
+        // pinned handles stay put and the pass carries on past them. Each call resumes where the last one stopped and
+        // takes at least one step, and returns true once the pass has reached the end of the arena (the next call
+        // starts over). Only the HoleList engine compacts; Buddy arenas and persistent arenas return true at once.
+        bool compact(chrono::microseconds budget);
+
+        // Returns true if memory has been initialized and no block is allocated from it. Blocks parked in thread caches
+        // in concurrent mode still count as allocated.
+        bool isEmpty();
 };
\ No newline at end of file
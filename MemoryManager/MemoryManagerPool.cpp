@@ -0,0 +1,140 @@
+#include "MemoryManagerPool.h"
+#include <sched.h>
+#include <thread>
+
+// Constructor - Sets native word size (in bytes, for alignment), the allocator function used in every arena and the
+// offset width of the arenas, which caps their size as in MemoryManager::initialize(). Bits16 is the default as for
+// MemoryManager; arenas over 65535 words need Bits32.
+MemoryManagerPool::MemoryManagerPool(unsigned wordSize, function<int(int, void*)> allocator, OffsetWidth offsetWidth) {
+    this->wordSize = wordSize;
+    this->allocator = allocator;
+    this->engine = Engine::HoleList;
+    this->offsetWidth = offsetWidth;
+}
+
+// Constructor - Same as above, with every arena run by an engine such as TLSF instead of an allocator function.
+MemoryManagerPool::MemoryManagerPool(unsigned wordSize, Engine engine, OffsetWidth offsetWidth)
+    : MemoryManagerPool(wordSize, bestFit, offsetWidth) {
+    this->engine = engine;
+}
+
+// Creates arenaCount arenas of sizeInWords words each, or one per configured CPU if arenaCount is 0. Cleans up previous
+// arenas if applicable. Must not race with other calls.
+void MemoryManagerPool::initialize(size_t sizeInWords, unsigned arenaCount) {
+    shutdown();
+    if (arenaCount == 0) { arenaCount = max(1u, thread::hardware_concurrency()); }
+
+    for (unsigned i = 0; i < arenaCount; i++) {
+        unique_ptr<Arena> arena(new Arena());
+        if (engine == Engine::HoleList) { arena->manager.reset(new MemoryManager(wordSize, allocator, offsetWidth)); }
+        else { arena->manager.reset(new MemoryManager(wordSize, engine, offsetWidth)); }
+        arena->manager->initialize(sizeInWords);
+        arena->remoteFrees = nullptr;
+        arena->start = static_cast<char*>(arena->manager->getMemoryStart());
+        arena->end = arena->start + arena->manager->getMemoryLimit();
+        arenasByStart.push_back(make_pair(arena->start, arena.get()));
+        arenas.push_back(move(arena));
+    }
+    sort(arenasByStart.begin(), arenasByStart.end());
+}
+
+// Releases every arena; any block still allocated becomes invalid. Must not race with other calls.
+void MemoryManagerPool::shutdown() {
+    arenasByStart.clear();
+    arenas.clear();
+}
+
+// Allocates from the calling CPU's arena, or the next one that can fit the block. Blocks are at least a pointer in size
+// so a remote free can link them. If size is invalid or no arena can fit the block, returns nullptr. Safe to call from
+// any thread.
+void* MemoryManagerPool::allocate(size_t sizeInBytes) {
+    if (sizeInBytes == 0 || arenas.empty()) { return nullptr; }
+    size_t bytes = max(sizeInBytes, sizeof(void*)); // Room for the remote-free link once the block is freed
+
+    // Spill over to the following arenas in turn when the home arena is full
+    unsigned home = currentArena();
+    for (size_t i = 0; i < arenas.size(); i++) {
+        Arena& arena = *arenas[(home + i) % arenas.size()];
+        lock_guard<mutex> lock(arena.lock);
+        drainRemoteFrees(arena);
+        void* block = arena.manager->allocate(bytes);
+        if (block != nullptr) { return block; }
+    }
+    return nullptr;
+}
+
+// Frees a block into its owning arena: directly if that is the calling CPU's arena, otherwise through the owner's
+// remote-free stack without taking its lock. Addresses outside every arena are ignored; anything else must have been
+// returned by allocate(). Safe to call from any thread.
+void MemoryManagerPool::free(void* address) {
+    Arena* owner = findArena(address);
+    if (owner == nullptr) { return; }
+
+    if (owner == arenas[currentArena()].get()) {
+        lock_guard<mutex> lock(owner->lock);
+        owner->manager->free(address);
+        return;
+    }
+
+    // Push onto the owner's stack; the link goes through memcpy as blocks are only word aligned
+    void* head = owner->remoteFrees.load(memory_order_relaxed);
+    do {
+        memcpy(address, &head, sizeof(head));
+    } while (!owner->remoteFrees.compare_exchange_weak(head, address, memory_order_release, memory_order_relaxed));
+}
+
+// Frees every block waiting on a remote-free stack, so each arena's hole list and bitmap are exact.
+void MemoryManagerPool::flushRemoteFrees() {
+    for (auto& arena : arenas) {
+        lock_guard<mutex> lock(arena->lock);
+        drainRemoteFrees(*arena);
+    }
+}
+
+// Returns the arena a block was allocated from, for looking at its hole list or bitmap, or nullptr. Reading the arena
+// races with other threads using the pool.
+MemoryManager* MemoryManagerPool::getArena(void* address) {
+    Arena* arena = findArena(address);
+    return (arena == nullptr) ? nullptr : arena->manager.get();
+}
+
+// Returns the arena used by threads running on cpu.
+MemoryManager* MemoryManagerPool::getArenaForCpu(unsigned cpu) {
+    if (arenas.empty()) { return nullptr; }
+    return arenas[cpu % arenas.size()]->manager.get();
+}
+
+// Returns the number of arenas.
+size_t MemoryManagerPool::getArenaCount() {
+    return arenas.size();
+}
+
+// Returns the index of the arena for the CPU the calling thread is running on. The thread may migrate right after,
+// which only costs a remote free later.
+unsigned MemoryManagerPool::currentArena() {
+    int cpu = sched_getcpu();
+    return (cpu < 0) ? 0 : (unsigned)cpu % arenas.size();
+}
+
+// Returns the arena whose memory contains address, or nullptr. Arenas never overlap, so only the one starting last at
+// or before address can hold it, found by binary search.
+MemoryManagerPool::Arena* MemoryManagerPool::findArena(void* address) {
+    char* byte = static_cast<char*>(address);
+    auto next = upper_bound(arenasByStart.begin(), arenasByStart.end(), byte,
+        [](char* byte, const pair<char*, Arena*>& arena) { return byte < arena.first; });
+    if (next == arenasByStart.begin()) { return nullptr; }
+    Arena* arena = prev(next)->second;
+    return (byte < arena->end) ? arena : nullptr;
+}
+
+// Takes the arena's whole remote-free stack in one exchange and frees it as a batch. The arena's lock must be held.
+void MemoryManagerPool::drainRemoteFrees(Arena& arena) {
+    if (arena.remoteFrees.load(memory_order_relaxed) == nullptr) { return; }
+    void* block = arena.remoteFrees.exchange(nullptr, memory_order_acquire);
+    while (block != nullptr) {
+        arena.drained.push_back(block);
+        memcpy(&block, block, sizeof(block));
+    }
+    arena.manager->freeMany(arena.drained.data(), arena.drained.size());
+    arena.drained.clear();
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "MemoryManager.h"
+
+// Memory manager sharded across independent arenas, one per CPU by default, so threads running on different cores
+// allocate without sharing a lock or a cache line. Each allocation goes to the arena of the CPU the calling thread is
+// running on (sched_getcpu()), spilling over to the others only when that one is full. A block freed from another
+// CPU is pushed onto its owning arena's lock-free remote-free stack instead of taking that arena's lock, and the
+// owner frees the whole stack with one freeMany() on its next allocation.
+class MemoryManagerPool {
+    private:
+        struct Arena {
+            alignas(64) mutex lock; // Guards manager and drained; own cache line so arenas never false-share
+            unique_ptr<MemoryManager> manager;
+            vector<void*> drained; // Reused buffer for draining remoteFrees
+            // Blocks freed from other CPUs, linked through their first bytes. On a cache line of its own with the
+            // bounds a remote free reads, so pushing a block never contends with the owner's lock.
+            alignas(64) atomic<void*> remoteFrees;
+            char* start; // Arena bounds, fixed once initialized
+            char* end;
+        };
+
+        unsigned wordSize;
+        function<int(int, void*)> allocator;
+        Engine engine;
+        OffsetWidth offsetWidth;
+        vector<unique_ptr<Arena>> arenas; // Threads on CPU c use arenas[c % arenas.size()]
+        vector<pair<char*, Arena*>> arenasByStart; // (start, arena) of every arena, sorted for findArena()
+
+        unsigned currentArena();
+        Arena* findArena(void* address);
+        void drainRemoteFrees(Arena& arena);
+
+    public:
+        // Constructor - Sets native word size (in bytes, for alignment), the allocator function used in every arena
+        // and the offset width of the arenas, which caps their size as in MemoryManager::initialize(). Bits16 is the
+        // default as for MemoryManager; arenas over 65535 words need Bits32.
+        MemoryManagerPool(unsigned wordSize, function<int(int, void*)> allocator,
+            OffsetWidth offsetWidth = OffsetWidth::Bits16);
+        // Constructor - Same as above, with every arena run by an engine such as TLSF instead of an allocator function.
+        MemoryManagerPool(unsigned wordSize, Engine engine, OffsetWidth offsetWidth = OffsetWidth::Bits16);
+
+        MemoryManagerPool(const MemoryManagerPool&) = delete;
+        MemoryManagerPool& operator=(const MemoryManagerPool&) = delete;
+
+        // Creates arenaCount arenas of sizeInWords words each, or one per configured CPU if arenaCount is 0. Cleans up
+        // previous arenas if applicable. Must not race with other calls.
+        void initialize(size_t sizeInWords, unsigned arenaCount = 0);
+
+        // Releases every arena; any block still allocated becomes invalid. Must not race with other calls.
+        void shutdown();
+
+        // Allocates from the calling CPU's arena, or the next one that can fit the block. Blocks are at least a
+        // pointer in size so a remote free can link them. If size is invalid or no arena can fit the block, returns
+        // nullptr. Safe to call from any thread.
+        void* allocate(size_t sizeInBytes);
+
+        // Frees a block into its owning arena: directly if that is the calling CPU's arena, otherwise through the
+        // owner's remote-free stack without taking its lock. Addresses outside every arena are ignored; anything else
+        // must have been returned by allocate(). Safe to call from any thread.
+        void free(void* address);
+
+        // Frees every block waiting on a remote-free stack, so each arena's hole list and bitmap are exact.
+        void flushRemoteFrees();
+
+        // Returns the arena a block was allocated from, for looking at its hole list or bitmap, or nullptr. Reading
+        // the arena races with other threads using the pool.
+        MemoryManager* getArena(void* address);
+
+        // Returns the arena used by threads running on cpu.
+        MemoryManager* getArenaForCpu(unsigned cpu);
+
+        // Returns the number of arenas.
+        size_t getArenaCount();
+};
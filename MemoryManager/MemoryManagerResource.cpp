@@ -0,0 +1,34 @@
+#include "MemoryManagerResource.h"
+
+// Constructor - Serves allocations from memoryManager, which must outlive the resource and everything
+// allocated through it.
+MemoryManagerResource::MemoryManagerResource(MemoryManager& memoryManager) : memoryManager(memoryManager) {
+}
+
+// Returns the memory manager allocations are served from.
+MemoryManager& MemoryManagerResource::getMemoryManager() {
+    return memoryManager;
+}
+
+// Allocates at least bytes bytes aligned to alignment, throwing std::bad_alloc if the arena has no room. Zero-byte
+// requests take a word so every allocation has an address of its own.
+void* MemoryManagerResource::do_allocate(size_t bytes, size_t alignment) {
+    if (bytes == 0) { bytes = 1; }
+
+    // Blocks start on word boundaries of a page-aligned arena, so alignments dividing the word size come for free
+    bool wordAligned = memoryManager.getWordSize() % alignment == 0;
+    void* block = wordAligned ? memoryManager.allocate(bytes) : memoryManager.allocateAligned(bytes, alignment);
+    if (block == nullptr) { throw std::bad_alloc(); }
+    return block;
+}
+
+// Returns the block to the memory manager. The size is the one it was allocated with, so the sized free applies.
+void MemoryManagerResource::do_deallocate(void* pointer, size_t bytes, size_t) {
+    memoryManager.free(pointer, (bytes == 0) ? 1 : bytes);
+}
+
+// Resources are interchangeable when they allocate from the same memory manager.
+bool MemoryManagerResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    const MemoryManagerResource* resource = dynamic_cast<const MemoryManagerResource*>(&other);
+    return resource != nullptr && &resource->memoryManager == &memoryManager;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "MemoryManager.h"
+#include <memory_resource>
+
+// std::pmr::memory_resource over a MemoryManager, so std::pmr containers keep their nodes and buffers in one
+// contiguous arena instead of scattering them across the global heap. Requests whose alignment every word boundary
+// already satisfies go through allocate(), and so through the thread caches in concurrent mode; stricter alignments
+// use allocateAligned(). Failures throw std::bad_alloc as the memory_resource contract requires.
+class MemoryManagerResource : public std::pmr::memory_resource {
+    private:
+        MemoryManager& memoryManager;
+
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    public:
+        // Constructor - Serves allocations from memoryManager, which must outlive the resource and everything
+        // allocated through it.
+        MemoryManagerResource(MemoryManager& memoryManager);
+
+        MemoryManagerResource(const MemoryManagerResource&) = delete;
+        MemoryManagerResource& operator=(const MemoryManagerResource&) = delete;
+
+        // Returns the memory manager allocations are served from.
+        MemoryManager& getMemoryManager();
+};
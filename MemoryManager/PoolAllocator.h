@@ -0,0 +1,134 @@
+#pragma once
+
+#include "MemoryManager.h"
+#include <map>
+
+// Fixed-size block pool layered on a MemoryManager. Slabs of BlocksPerSlab blocks are carved out of the arena with
+// a single allocate() each, and blocks are served from the slab's free list in O(1) without a fit search. A slab
+// goes back to the memory manager's holes as soon as its last block is freed.
+template <size_t BlockSize, size_t BlocksPerSlab = 64>
+class PoolAllocator {
+    static_assert(BlockSize > 0, "PoolAllocator blocks must be at least one byte");
+    static_assert(BlocksPerSlab > 0 && BlocksPerSlab <= 65536, "PoolAllocator slabs hold 1 to 65536 blocks");
+
+    private:
+        struct Slab {
+            char* start;
+            vector<uint16_t> freeBlocks; // Indexes of free blocks in this slab, used as a stack
+            Slab* previous; // Neighbours in the list of slabs that still have free blocks
+            Slab* next;
+        };
+
+        MemoryManager& memoryManager;
+        size_t stride; // BlockSize rounded up to whole words so every block stays word aligned
+        map<char*, Slab> slabs; // By start address, to find the slab a freed block belongs to
+        Slab* available; // Slabs with at least one free block
+
+        void link(Slab* slab);
+        void unlink(Slab* slab);
+
+    public:
+        // Constructor - Serves blocks from slabs allocated out of memoryManager, which must outlive the pool.
+        PoolAllocator(MemoryManager& memoryManager);
+        // Destructor - Returns every slab to the memory manager, including ones with blocks still in use.
+        ~PoolAllocator();
+
+        PoolAllocator(const PoolAllocator&) = delete;
+        PoolAllocator& operator=(const PoolAllocator&) = delete;
+
+        // Returns a block of BlockSize bytes, or nullptr if the memory manager has no room for another slab.
+        void* allocate();
+
+        // Returns a block to its slab, handing the slab back to the memory manager if it is now empty. Addresses that
+        // were not returned by allocate() are ignored.
+        void free(void* block);
+
+        // Returns the number of slabs currently held from the memory manager.
+        size_t getSlabCount();
+};
+
+// Constructor - Serves blocks from slabs allocated out of memoryManager, which must outlive the pool.
+template <size_t BlockSize, size_t BlocksPerSlab>
+PoolAllocator<BlockSize, BlocksPerSlab>::PoolAllocator(MemoryManager& memoryManager) : memoryManager(memoryManager) {
+    unsigned wordSize = memoryManager.getWordSize();
+    this->stride = (BlockSize + wordSize - 1) / wordSize * wordSize;
+    this->available = nullptr;
+}
+
+// Destructor - Returns every slab to the memory manager, including ones with blocks still in use.
+template <size_t BlockSize, size_t BlocksPerSlab>
+PoolAllocator<BlockSize, BlocksPerSlab>::~PoolAllocator() {
+    for (auto& slab : slabs) {
+        memoryManager.free(slab.first);
+    }
+}
+
+// Returns a block of BlockSize bytes, or nullptr if the memory manager has no room for another slab.
+template <size_t BlockSize, size_t BlocksPerSlab>
+void* PoolAllocator<BlockSize, BlocksPerSlab>::allocate() {
+    // Carve a new slab when every existing one is full
+    if (available == nullptr) {
+        char* start = static_cast<char*>(memoryManager.allocate(stride * BlocksPerSlab));
+        if (start == nullptr) { return nullptr; }
+
+        Slab& slab = slabs[start];
+        slab.start = start;
+        slab.freeBlocks.resize(BlocksPerSlab);
+        for (size_t i = 0; i < BlocksPerSlab; i++) { // Hand out low addresses first
+            slab.freeBlocks[i] = BlocksPerSlab - 1 - i;
+        }
+        link(&slab);
+    }
+
+    Slab* slab = available;
+    unsigned index = slab->freeBlocks.back();
+    slab->freeBlocks.pop_back();
+    if (slab->freeBlocks.empty()) { unlink(slab); } // Slab is full
+    return slab->start + index*stride;
+}
+
+// Returns a block to its slab, handing the slab back to the memory manager if it is now empty. Addresses that
+// were not returned by allocate() are ignored.
+template <size_t BlockSize, size_t BlocksPerSlab>
+void PoolAllocator<BlockSize, BlocksPerSlab>::free(void* block) {
+    // Find the slab starting at or before the block
+    auto entry = slabs.upper_bound(static_cast<char*>(block));
+    if (entry == slabs.begin()) { return; }
+    Slab& slab = (--entry)->second;
+
+    size_t byteOffset = static_cast<char*>(block) - slab.start;
+    if (byteOffset >= stride * BlocksPerSlab || byteOffset % stride != 0) { return; }
+
+    if (slab.freeBlocks.empty()) { link(&slab); } // Slab was full, it can serve blocks again
+    slab.freeBlocks.push_back(byteOffset / stride);
+
+    // Give the whole slab back once nothing in it is in use
+    if (slab.freeBlocks.size() == BlocksPerSlab) {
+        unlink(&slab);
+        memoryManager.free(slab.start);
+        slabs.erase(entry);
+    }
+}
+
+// Returns the number of slabs currently held from the memory manager.
+template <size_t BlockSize, size_t BlocksPerSlab>
+size_t PoolAllocator<BlockSize, BlocksPerSlab>::getSlabCount() {
+    return slabs.size();
+}
+
+// Pushes a slab onto the list of slabs with free blocks.
+template <size_t BlockSize, size_t BlocksPerSlab>
+void PoolAllocator<BlockSize, BlocksPerSlab>::link(Slab* slab) {
+    slab->previous = nullptr;
+    slab->next = available;
+    if (available != nullptr) { available->previous = slab; }
+    available = slab;
+}
+
+// Removes a slab from the list of slabs with free blocks.
+template <size_t BlockSize, size_t BlocksPerSlab>
+void PoolAllocator<BlockSize, BlocksPerSlab>::unlink(Slab* slab) {
+    if (slab->previous != nullptr) { slab->previous->next = slab->next; }
+    else { available = slab->next; }
+    if (slab->next != nullptr) { slab->next->previous = slab->previous; }
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "MemoryManager.h"
+
+// Memory manager whose arena and bookkeeping are fixed-size arrays sized at compile time, for embedded targets and
+// per-frame arenas where nothing may touch the heap. The constructor is constexpr and leaves every byte zero, which
+// is already the state of an empty arena, so a static instance is constant-initialized into .bss and one on the stack
+// costs a single memset. Holes are the runs of free words in the bitmap, located with the built-in Policy by scanning
+// it 64 words at a time, and getList() and getBitmap() write the Bits16 layouts of MemoryManager into caller buffers.
+template <unsigned WordSize, size_t Words, FitPolicy Policy = FitPolicy::BestFit>
+class StaticMemoryManager {
+    static_assert(WordSize > 0, "StaticMemoryManager words must be at least one byte");
+    static_assert(Words > 0 && Words <= 65535, "StaticMemoryManager arenas hold 1 to 65535 words (Bits16 offsets)");
+    static_assert(Policy != FitPolicy::Custom, "StaticMemoryManager only serves the built-in fit policies");
+
+    private:
+        alignas(max_align_t) char memory[(size_t)WordSize*Words] = {};
+        uint16_t partitions[Words] = {}; // Length in words of the partition starting at each word offset, 0 if none
+        uint64_t bitmap[(Words + 63) / 64] = {}; // One bit per word, word i is bit (i % 64) of bitmap[i / 64]
+        size_t wordsInUse = 0;
+        unsigned nextFitCursor = 0; // Word just past the last next-fit allocation
+
+        void markWords(unsigned offset, unsigned length, bool used);
+        unsigned findBit(unsigned from, bool used) const;
+        int selectRun(unsigned sizeInWords);
+        size_t countHoles() const;
+
+    public:
+        // Constructor - Every word starts out free; no call to initialize() is needed.
+        constexpr StaticMemoryManager() = default;
+
+        StaticMemoryManager(const StaticMemoryManager&) = delete;
+        StaticMemoryManager& operator=(const StaticMemoryManager&) = delete;
+
+        // Allocates a block from the hole Policy picks. If no hole fits or size is invalid, returns nullptr.
+        void* allocate(size_t sizeInBytes);
+
+        // Frees a block so that it can be reused. Addresses that were not returned by allocate() are ignored.
+        void free(void* address);
+
+        // Frees every block at once.
+        void reset();
+
+        // Returns the bytes getList() writes: the hole count and an offset and length per hole, uint16_t each.
+        size_t getListBytes() const;
+
+        // Writes the hole list in the layout of MemoryManager::getList() with Bits16 offsets to buffer. Returns the
+        // bytes written, or 0 if they do not fit in bufferBytes.
+        size_t getList(void* buffer, size_t bufferBytes) const;
+
+        // Returns the bytes getBitmap() writes: a two-byte size followed by one bit per word.
+        static constexpr size_t getBitmapBytes() { return 2 + (Words + 7) / 8; }
+
+        // Writes the bitmap in the layout of MemoryManager::getBitmap() with Bits16 offsets to buffer. Returns the
+        // bytes written, or 0 if they do not fit in bufferBytes.
+        size_t getBitmap(void* buffer, size_t bufferBytes) const;
+
+        // Returns the word size used for alignment.
+        static constexpr unsigned getWordSize() { return WordSize; }
+
+        // Returns the byte-wise memory address of the beginning of the memory block.
+        void* getMemoryStart() { return memory; }
+
+        // Returns the byte limit of the memory block.
+        static constexpr size_t getMemoryLimit() { return (size_t)WordSize*Words; }
+
+        // Returns true if no block is allocated.
+        bool isEmpty() const { return wordsInUse == 0; }
+};
+
+// Allocates a block from the hole Policy picks. If no hole fits or size is invalid, returns nullptr.
+template <unsigned WordSize, size_t Words, FitPolicy Policy>
+void* StaticMemoryManager<WordSize, Words, Policy>::allocate(size_t sizeInBytes) {
+    if (sizeInBytes == 0 || sizeInBytes > getMemoryLimit()) { return nullptr; }
+    unsigned words = (sizeInBytes + WordSize - 1) / WordSize; // Round up to whole words
+
+    int offset = selectRun(words);
+    if (offset == -1) { return nullptr; } // No hole can fit allocation
+    partitions[offset] = words;
+    markWords(offset, words, true);
+    wordsInUse += words;
+    if (Policy == FitPolicy::NextFit) { nextFitCursor = (offset + words) % Words; }
+    return &memory[(size_t)offset*WordSize];
+}
+
+// Frees a block so that it can be reused. Addresses that were not returned by allocate() are ignored.
+template <unsigned WordSize, size_t Words, FitPolicy Policy>
+void StaticMemoryManager<WordSize, Words, Policy>::free(void* address) {
+    char* block = static_cast<char*>(address);
+    if (block < memory || block >= memory + getMemoryLimit()) { return; }
+    size_t byteOffset = block - memory;
+    if (byteOffset % WordSize != 0) { return; }
+    unsigned wordOffset = byteOffset / WordSize;
+    if (partitions[wordOffset] == 0) { return; } // Not the start of a live partition
+
+    // Freed words rejoin the runs on either side simply by clearing their bits
+    markWords(wordOffset, partitions[wordOffset], false);
+    wordsInUse -= partitions[wordOffset];
+    partitions[wordOffset] = 0;
+}
+
+// Frees every block at once.
+template <unsigned WordSize, size_t Words, FitPolicy Policy>
+void StaticMemoryManager<WordSize, Words, Policy>::reset() {
+    fill(partitions, partitions + Words, 0);
+    fill(bitmap, bitmap + (Words + 63) / 64, 0);
+    wordsInUse = 0;
+    nextFitCursor = 0;
+}
+
+// Returns the bytes getList() writes: the hole count and an offset and length per hole, uint16_t each.
+template <unsigned WordSize, size_t Words, FitPolicy Policy>
+size_t StaticMemoryManager<WordSize, Words, Policy>::getListBytes() const {
+    return (1 + 2*countHoles()) * sizeof(uint16_t);
+}
+
+// Writes the hole list in the layout of MemoryManager::getList() with Bits16 offsets to buffer. Returns the bytes
+// written, or 0 if they do not fit in bufferBytes.
+template <unsigned WordSize, size_t Words, FitPolicy Policy>
+size_t StaticMemoryManager<WordSize, Words, Policy>::getList(void* buffer, size_t bufferBytes) const {
+    size_t bytes = getListBytes();
+    if (bufferBytes < bytes) { return 0; }
+
+    uint16_t* list = static_cast<uint16_t*>(buffer);
+    *list++ = (bytes / sizeof(uint16_t) - 1) / 2;
+    for (unsigned start = findBit(0, false); start < Words;) {
+        unsigned end = findBit(start, true);
+        *list++ = start;
+        *list++ = end - start;
+        start = findBit(end, false);
+    }
+    return bytes;
+}
+
+// Writes the bitmap in the layout of MemoryManager::getBitmap() with Bits16 offsets to buffer. Returns the bytes
+// written, or 0 if they do not fit in bufferBytes.
+template <unsigned WordSize, size_t Words, FitPolicy Policy>
+size_t StaticMemoryManager<WordSize, Words, Policy>::getBitmap(void* buffer, size_t bufferBytes) const {
+    if (bufferBytes < getBitmapBytes()) { return 0; }
+
+    uint8_t* bits = static_cast<uint8_t*>(buffer);
+    uint16_t size = (Words + 7) / 8;
+    bits[0] = (uint8_t)size; // Size of bitmap (Little-Endian)
+    bits[1] = (uint8_t)(size >> 8);
+    for (unsigned i = 0; i < size; i++) { // Pull each byte out of its 64-bit word
+        bits[i + 2] = (uint8_t)(bitmap[i/8] >> ((i%8)*8));
+    }
+    return getBitmapBytes();
+}
+
+// Sets (used) or clears (free) the bitmap bits of a run of words.
+template <unsigned WordSize, size_t Words, FitPolicy Policy>
+void StaticMemoryManager<WordSize, Words, Policy>::markWords(unsigned offset, unsigned length, bool used) {
+    markBitmapWords(bitmap, offset, length, used);
+}
+
+// Returns the first word at or after from whose bit is used (1) or free (0), or Words if there is none.
+template <unsigned WordSize, size_t Words, FitPolicy Policy>
+unsigned StaticMemoryManager<WordSize, Words, Policy>::findBit(unsigned from, bool used) const {
+    return findBitmapBit(bitmap, Words, from, used);
+}
+
+// Returns the offset of the run of free words Policy picks for sizeInWords, or -1 if none is long enough. Next fit
+// starts at the cursor and wraps around once.
+template <unsigned WordSize, size_t Words, FitPolicy Policy>
+int StaticMemoryManager<WordSize, Words, Policy>::selectRun(unsigned sizeInWords) {
+    int selected = -1;
+    unsigned selectedLength = 0;
+    unsigned from = (Policy == FitPolicy::NextFit) ? nextFitCursor : 0;
+    for (unsigned start = findBit(from, false); start < Words;) {
+        unsigned end = findBit(start, true);
+        unsigned length = end - start;
+        if (length >= sizeInWords) {
+            if (Policy == FitPolicy::FirstFit || Policy == FitPolicy::NextFit) { return start; }
+            if (Policy == FitPolicy::BestFit && length == sizeInWords) { return start; } // Cannot do better
+            bool better = (Policy == FitPolicy::BestFit) ? (selected == -1 || length < selectedLength)
+                                                         : length > selectedLength;
+            if (better) {
+                selected = start;
+                selectedLength = length;
+            }
+        }
+        start = findBit(end, false);
+    }
+    if (Policy == FitPolicy::NextFit && from != 0) {
+        nextFitCursor = 0;
+        return selectRun(sizeInWords);
+    }
+    return selected;
+}
+
+// Returns the number of runs of free words.
+template <unsigned WordSize, size_t Words, FitPolicy Policy>
+size_t StaticMemoryManager<WordSize, Words, Policy>::countHoles() const {
+    size_t count = 0;
+    for (unsigned start = findBit(0, false); start < Words; start = findBit(findBit(start, true), false)) {
+        count++;
+    }
+    return count;
+}
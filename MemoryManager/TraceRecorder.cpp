@@ -0,0 +1,117 @@
+#include "TraceRecorder.h"
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Returns steady_clock time in nanoseconds.
+static uint64_t nowNanoseconds() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Writes all of length bytes, retrying short or interrupted writes. Returns false on error.
+static bool writeAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t result = write(fd, data, length);
+        if (result == -1 && errno == EINTR) { continue; }
+        if (result <= 0) { return false; }
+        data += result;
+        length -= result;
+    }
+    return true;
+}
+
+// Constructor - Creates or replaces filename and writes the trace header. Check isOpen() before use.
+TraceRecorder::TraceRecorder(const char* filename, unsigned wordSize) : slots(capacity) {
+    for (size_t i = 0; i < capacity; i++) { slots[i].sequence.store(i, memory_order_relaxed); }
+    this->writePosition = 0;
+    this->readPosition = 0;
+    this->dropped = 0;
+    this->stopping = false;
+    this->start = nowNanoseconds();
+
+    this->fd = open(filename, O_CREAT | O_WRONLY | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fd == -1) { return; }
+    TraceHeader header;
+    memcpy(header.magic, "MMTRACE1", 8);
+    header.wordSize = wordSize;
+    header.recordSize = sizeof(TraceRecord);
+    if (!writeAll(fd, (const char*)&header, sizeof(header))) {
+        close(fd);
+        fd = -1;
+        return;
+    }
+    flusher = thread(&TraceRecorder::flushLoop, this);
+}
+
+// Destructor - Same as stop().
+TraceRecorder::~TraceRecorder() {
+    stop();
+}
+
+// Returns true if the trace file could be created.
+bool TraceRecorder::isOpen() {
+    return fd != -1;
+}
+
+// Adds a record to the ring, or counts it as dropped if the ring is full. Never blocks.
+void TraceRecorder::record(TraceEvent event, uint64_t size, uint32_t offset, uint32_t hole) {
+    uint64_t position = writePosition.load(memory_order_relaxed);
+    Slot* slot;
+    while (true) { // Claim the next slot, unless the flush thread has not emptied it yet
+        slot = &slots[position & (capacity - 1)];
+        int64_t lag = (int64_t)slot->sequence.load(memory_order_acquire) - (int64_t)position;
+        if (lag == 0 && writePosition.compare_exchange_weak(position, position + 1, memory_order_relaxed)) { break; }
+        if (lag < 0) { // Full
+            dropped.fetch_add(1, memory_order_relaxed);
+            return;
+        }
+        if (lag > 0) { position = writePosition.load(memory_order_relaxed); } // Another thread took it
+    }
+
+    slot->record.timestamp = nowNanoseconds() - start;
+    slot->record.size = size;
+    slot->record.offset = offset;
+    slot->record.hole = hole;
+    slot->record.event = event;
+    memset(slot->record.padding, 0, sizeof(slot->record.padding));
+    slot->sequence.store(position + 1, memory_order_release);
+}
+
+// Drains the ring into the file until stop() is called, then drains it one last time.
+void TraceRecorder::flushLoop() {
+    vector<TraceRecord> buffer;
+    buffer.reserve(4096);
+    while (true) {
+        bool last = stopping.load(memory_order_acquire); // Read first, so the final pass sees every record
+        while (true) {
+            Slot& slot = slots[readPosition & (capacity - 1)];
+            if (slot.sequence.load(memory_order_acquire) != readPosition + 1) { break; } // Not written yet
+            buffer.push_back(slot.record);
+            slot.sequence.store(readPosition + capacity, memory_order_release); // Free for the next lap
+            readPosition++;
+            if (buffer.size() == buffer.capacity()) { break; }
+        }
+
+        bool drained = buffer.size() < buffer.capacity();
+        if (!buffer.empty()) {
+            writeAll(fd, (const char*)buffer.data(), buffer.size() * sizeof(TraceRecord));
+            buffer.clear();
+        }
+        if (last && drained) { return; }
+        if (drained) { this_thread::sleep_for(chrono::milliseconds(1)); }
+    }
+}
+
+// Stops the flush thread once every record in the ring has reached the file, and closes it. Returns how many records
+// were dropped over the whole trace.
+uint64_t TraceRecorder::stop() {
+    if (fd != -1) {
+        stopping.store(true, memory_order_release);
+        flusher.join();
+        close(fd);
+        fd = -1;
+    }
+    return dropped.load(memory_order_relaxed);
+}
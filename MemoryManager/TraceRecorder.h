@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+// Events in an allocation trace.
+enum class TraceEvent : uint8_t { Allocate, Free, SetAllocator };
+
+// One event of an allocation trace, as stored in the trace file (host byte order).
+struct TraceRecord {
+    uint64_t timestamp; // Nanoseconds since the trace started
+    uint64_t size; // Bytes requested for Allocate, bytes freed for Free, the new FitPolicy for SetAllocator
+    uint32_t offset; // Word offset of the block, or noOffset if the allocation failed
+    uint32_t hole; // Word offset of the hole an allocation was carved from, or noOffset if it came from a cache
+    TraceEvent event;
+    uint8_t padding[7];
+
+    static constexpr uint32_t noOffset = UINT32_MAX;
+};
+
+// Header at the start of a trace file, followed by TraceRecords until the end of the file.
+struct TraceHeader {
+    char magic[8]; // "MMTRACE1"
+    uint32_t wordSize;
+    uint32_t recordSize; // sizeof(TraceRecord), so readers can check the layout
+};
+
+// Records allocation events into a bounded lock-free ring and writes them to a file from a background thread, so
+// the threads being traced never wait on the disk. Any number of threads may record at once (a Vyukov bounded
+// queue); when the ring is full the record is dropped and counted instead of blocking.
+class TraceRecorder {
+    private:
+        struct Slot {
+            atomic<uint64_t> sequence; // Position the slot is ready to be written at, or read at once it is + 1
+            TraceRecord record;
+        };
+
+        static constexpr size_t capacity = 1 << 16; // Records, a power of two
+        vector<Slot> slots;
+        atomic<uint64_t> writePosition;
+        uint64_t readPosition; // Only the flush thread reads
+        atomic<uint64_t> dropped;
+        atomic<bool> stopping;
+        uint64_t start; // steady_clock nanoseconds when the trace started
+        int fd;
+        thread flusher;
+
+        // Drains the ring into the file until stop() is called, then drains it one last time.
+        void flushLoop();
+
+    public:
+        // Constructor - Creates or replaces filename and writes the trace header. Check isOpen() before use.
+        TraceRecorder(const char* filename, unsigned wordSize);
+        // Destructor - Same as stop().
+        ~TraceRecorder();
+
+        TraceRecorder(const TraceRecorder&) = delete;
+        TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+        // Returns true if the trace file could be created.
+        bool isOpen();
+
+        // Adds a record to the ring, or counts it as dropped if the ring is full. Never blocks.
+        void record(TraceEvent event, uint64_t size, uint32_t offset, uint32_t hole);
+
+        // Stops the flush thread once every record in the ring has reached the file, and closes it. Returns how many
+        // records were dropped over the whole trace.
+        uint64_t stop();
+};
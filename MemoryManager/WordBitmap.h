@@ -0,0 +1,34 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+// Bitmap helpers shared by MemoryManager and StaticMemoryManager. Both keep one bit per arena word, word i being bit
+// (i % 64) of bitmap[i / 64], with used words set.
+
+// Sets (used) or clears (free) the bitmap bits of a run of words, a whole 64-bit word at a time where possible.
+inline void markBitmapWords(uint64_t* bitmap, unsigned offset, unsigned length, bool used) {
+    unsigned end = offset + length;
+    while (offset < end) {
+        unsigned bit = offset % 64;
+        unsigned count = min(64 - bit, end - offset);
+        uint64_t mask = (count == 64) ? ~0ull : ((1ull << count) - 1) << bit;
+        if (used) { bitmap[offset/64] |= mask; }
+        else { bitmap[offset/64] &= ~mask; }
+        offset += count;
+    }
+}
+
+// Returns the first of words words at or after from whose bit is used (1) or free (0), or words if there is none.
+inline unsigned findBitmapBit(const uint64_t* bitmap, size_t words, unsigned from, bool used) {
+    while (from < words) {
+        uint64_t word = used ? bitmap[from/64] : ~bitmap[from/64];
+        word &= ~0ull << (from % 64); // Ignore bits before from
+        if (word != 0) { return min((size_t)(from - from%64 + __builtin_ctzll(word)), words); }
+        from = from - from%64 + 64; // Whole word is the wrong kind, skip all 64 words
+    }
+    return words;
+}